@@ -0,0 +1,363 @@
+#ifndef GDWG_ALGORITHM_H
+#	define GDWG_ALGORITHM_H
+
+#	include "gdwg_graph.h"
+
+#	include <algorithm>
+#	include <bit>
+#	include <cstdint>
+#	include <functional>
+#	include <stdexcept>
+#	include <string>
+#	include <type_traits>
+#	include <utility>
+#	include <vector>
+
+namespace gdwg {
+	namespace detail {
+		struct search;
+	} // namespace detail
+
+	// Scratch space for the searches below. A search empties it in constant time and keeps its
+	// allocations, so searches run through one workspace stop allocating once it has grown to the
+	// size of the graph. Afterwards it still describes the last search, see reached() and path_to().
+	template<typename N, typename E>
+	class search_workspace {
+	 public:
+		search_workspace() = default;
+
+		// node must be a node of the searched graph, e.g. one handed to a visitor or returned by a search
+		[[nodiscard]] auto reached(N const& node) const noexcept -> bool {
+			return find(&node) != nullptr;
+		}
+
+		// the nodes from the source of the last search to node, empty if the search didn't reach it
+		[[nodiscard]] auto path_to(N const& node) const -> std::vector<N> {
+			auto path = std::vector<N>{};
+			for (auto s = find(&node); s != nullptr; s = find(s->parent)) {
+				path.push_back(*s->node);
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+	 private:
+		// only dijkstra keeps distances, which graphs without weights have no use for
+		using distance_type = std::conditional_t<std::is_void_v<E>, std::size_t, E>;
+
+		struct slot {
+			N const* node{};
+			N const* parent{};
+			distance_type distance{};
+			std::size_t count{};
+			std::uint32_t stamp{};
+			bool settled{};
+		};
+
+		// open addressing on the address of the node. A slot only belongs to the current search if it
+		// carries the current stamp, so bumping the stamp empties the table
+		std::vector<slot> slots_;
+		std::size_t size_{};
+		std::size_t shift_{64};
+		std::uint32_t stamp_{1};
+		std::vector<std::pair<N const*, N const*>> frontier_;
+		std::vector<std::pair<distance_type, N const*>> heap_;
+
+		void reset() {
+			size_ = 0;
+			frontier_.clear();
+			heap_.clear();
+			if (++stamp_ == 0) {
+				std::fill(slots_.begin(), slots_.end(), slot{});
+				stamp_ = 1;
+			}
+		}
+
+		auto home(N const* node) const noexcept -> std::size_t {
+			return static_cast<std::size_t>((std::bit_cast<std::uintptr_t>(node) * 0x9E3779B97F4A7C15) >> shift_);
+		}
+
+		auto next(std::size_t i) const noexcept -> std::size_t {
+			return (i + 1) & (slots_.size() - 1);
+		}
+
+		auto find(N const* node) const noexcept -> slot const* {
+			if (node == nullptr or slots_.empty()) {
+				return nullptr;
+			}
+			for (auto i = home(node); slots_[i].stamp == stamp_; i = next(i)) {
+				if (slots_[i].node == node) {
+					return &slots_[i];
+				}
+			}
+			return nullptr;
+		}
+
+		// the slot of node, and whether the current search had to claim it
+		auto insert(N const* node) -> std::pair<slot&, bool> {
+			if ((size_ + 1) * 2 > slots_.size()) {
+				grow();
+			}
+			auto i = home(node);
+			for (; slots_[i].stamp == stamp_; i = next(i)) {
+				if (slots_[i].node == node) {
+					return {slots_[i], false};
+				}
+			}
+			++size_;
+			slots_[i] = slot{node, nullptr, distance_type{}, 0, stamp_, false};
+			return {slots_[i], true};
+		}
+
+		void grow() {
+			auto old = std::exchange(slots_, std::vector<slot>(slots_.empty() ? 16 : slots_.size() * 2));
+			shift_ = 64 - static_cast<std::size_t>(std::countr_zero(slots_.size()));
+			for (auto& s : old) {
+				if (s.stamp == stamp_) {
+					auto i = home(s.node);
+					while (slots_[i].stamp == stamp_) {
+						i = next(i);
+					}
+					slots_[i] = std::move(s);
+				}
+			}
+		}
+
+		friend struct detail::search;
+	};
+
+	namespace detail {
+		// visitors may return void to see every node, or something testable where true stops the search
+		template<typename F, typename... Args>
+		auto stops(F& visit, Args const&... args) -> bool {
+			if constexpr (std::is_void_v<std::invoke_result_t<F&, Args const&...>>) {
+				std::invoke(visit, args...);
+				return false;
+			}
+			else {
+				return static_cast<bool>(std::invoke(visit, args...));
+			}
+		}
+
+		struct search {
+			template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+			static auto source(graph<N, E, NodeIndex, InIndex, Instrument> const& g, N const& src, char const* caller)
+			    -> N const* {
+				auto node = g.find_node(src);
+				if (node == nullptr) {
+					auto emsg = std::string{"Cannot call gdwg::"} + caller + " if src doesn't exist in the graph";
+					throw std::runtime_error{emsg};
+				}
+				return node;
+			}
+
+			template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+			static auto bfs(graph<N, E, NodeIndex, InIndex, Instrument> const& g,
+			                N const& src,
+			                Visit& visit,
+			                search_workspace<N, E>& ws) -> N const* {
+				auto start = source(g, src, "bfs");
+				ws.reset();
+				ws.insert(start);
+				ws.frontier_.emplace_back(start, nullptr);
+				// the frontier is used as a queue that never pops, so it also keeps its capacity
+				for (auto head = std::size_t{0}; head != ws.frontier_.size(); ++head) {
+					auto node = ws.frontier_[head].first;
+					if (stops(visit, *node)) {
+						return node;
+					}
+					for (auto const& dst : g.connections_view(*node)) {
+						auto [s, claimed] = ws.insert(&dst);
+						if (claimed) {
+							s.parent = node;
+							ws.frontier_.emplace_back(&dst, node);
+						}
+					}
+				}
+				return nullptr;
+			}
+
+			template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+			static auto dfs(graph<N, E, NodeIndex, InIndex, Instrument> const& g,
+			                N const& src,
+			                Visit& visit,
+			                search_workspace<N, E>& ws) -> N const* {
+				auto start = source(g, src, "dfs");
+				ws.reset();
+				ws.frontier_.emplace_back(start, nullptr);
+				while (not ws.frontier_.empty()) {
+					auto [node, parent] = ws.frontier_.back();
+					ws.frontier_.pop_back();
+					auto [s, claimed] = ws.insert(node);
+					if (not claimed) {
+						continue;
+					}
+					s.parent = parent;
+					if (stops(visit, *node)) {
+						return node;
+					}
+					// pushed in reverse so the smallest connection is explored first
+					auto pushed = ws.frontier_.size();
+					for (auto const& dst : g.connections_view(*node)) {
+						if (ws.find(&dst) == nullptr) {
+							ws.frontier_.emplace_back(&dst, node);
+						}
+					}
+					std::reverse(ws.frontier_.begin() + static_cast<std::ptrdiff_t>(pushed), ws.frontier_.end());
+				}
+				return nullptr;
+			}
+
+			template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+			static auto dijkstra(graph<N, E, NodeIndex, InIndex, Instrument> const& g,
+			                     N const& src,
+			                     Visit& visit,
+			                     search_workspace<N, E>& ws,
+			                     E const& unweighted_cost) -> N const* {
+				auto start = source(g, src, "dijkstra");
+				ws.reset();
+				ws.insert(start);
+				ws.heap_.emplace_back(E{}, start);
+				auto later = [](auto const& a, auto const& b) { return b.first < a.first; };
+				while (not ws.heap_.empty()) {
+					std::pop_heap(ws.heap_.begin(), ws.heap_.end(), later);
+					auto [distance, node] = std::move(ws.heap_.back());
+					ws.heap_.pop_back();
+					auto& s = ws.insert(node).first;
+					// stale entries for a node are left in the heap and skipped once it has settled
+					if (s.settled) {
+						continue;
+					}
+					s.settled = true;
+					if (stops(visit, *node, distance)) {
+						return node;
+					}
+					for (auto const& e : g.edges_view(*node)) {
+						auto const& cost = e.weight() ? *e.weight() : unweighted_cost;
+						if (cost < E{}) {
+							auto emsg = std::string{"Cannot call gdwg::dijkstra on a graph with negative weights"};
+							throw std::runtime_error{emsg};
+						}
+						auto through = static_cast<E>(distance + cost);
+						auto [d, claimed] = ws.insert(&e.dst());
+						if (claimed or (not d.settled and through < d.distance)) {
+							d.distance = through;
+							d.parent = node;
+							ws.heap_.emplace_back(std::move(through), &e.dst());
+							std::push_heap(ws.heap_.begin(), ws.heap_.end(), later);
+						}
+					}
+				}
+				return nullptr;
+			}
+
+			template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+			static auto topological_sort(graph<N, E, NodeIndex, InIndex, Instrument> const& g, search_workspace<N, E>& ws)
+			    -> std::vector<N> {
+				ws.reset();
+				for (auto const& node : g.nodes_view()) {
+					ws.insert(&node);
+				}
+				for (auto const& node : g.nodes_view()) {
+					for (auto const& dst : g.connections_view(node)) {
+						++ws.insert(&dst).first.count;
+					}
+				}
+				for (auto const& node : g.nodes_view()) {
+					if (ws.insert(&node).first.count == 0) {
+						ws.frontier_.emplace_back(&node, nullptr);
+					}
+				}
+				for (auto head = std::size_t{0}; head != ws.frontier_.size(); ++head) {
+					auto node = ws.frontier_[head].first;
+					for (auto const& dst : g.connections_view(*node)) {
+						auto& s = ws.insert(&dst).first;
+						if (--s.count == 0) {
+							s.parent = node;
+							ws.frontier_.emplace_back(&dst, node);
+						}
+					}
+				}
+				if (ws.frontier_.size() != ws.size_) {
+					auto emsg = std::string{"Cannot call gdwg::topological_sort on a graph with a cycle"};
+					throw std::runtime_error{emsg};
+				}
+				auto order = std::vector<N>{};
+				order.reserve(ws.frontier_.size());
+				for (auto const& [node, parent] : ws.frontier_) {
+					order.push_back(*node);
+				}
+				return order;
+			}
+		};
+	} // namespace detail
+
+	// Breadth first search from src, visit(node) is called on each node reached in order of hops,
+	// connections in ascending order. The search stops at the first node visit returns true for and
+	// returns it, it returns nullptr once everything reachable was visited
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+	auto bfs(graph<N, E, NodeIndex, InIndex, Instrument> const& g,
+	         std::type_identity_t<N> const& src,
+	         Visit visit,
+	         search_workspace<N, E>& ws) -> N const* {
+		return detail::search::bfs(g, src, visit, ws);
+	}
+
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+	auto bfs(graph<N, E, NodeIndex, InIndex, Instrument> const& g, std::type_identity_t<N> const& src, Visit visit)
+	    -> N const* {
+		auto ws = search_workspace<N, E>{};
+		return detail::search::bfs(g, src, visit, ws);
+	}
+
+	// Depth first search from src in preorder, smallest connection first, otherwise as bfs
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+	auto dfs(graph<N, E, NodeIndex, InIndex, Instrument> const& g,
+	         std::type_identity_t<N> const& src,
+	         Visit visit,
+	         search_workspace<N, E>& ws) -> N const* {
+		return detail::search::dfs(g, src, visit, ws);
+	}
+
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+	auto dfs(graph<N, E, NodeIndex, InIndex, Instrument> const& g, std::type_identity_t<N> const& src, Visit visit)
+	    -> N const* {
+		auto ws = search_workspace<N, E>{};
+		return detail::search::dfs(g, src, visit, ws);
+	}
+
+	// Shortest paths from src, visit(node, distance) is called on each node reached once its distance
+	// is final, in order of distance. An edge costs its weight, or unweighted_cost if it has none, and
+	// negative costs throw. Stops early as bfs does, ws.path_to() gives the path of a visited node
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+	auto dijkstra(graph<N, E, NodeIndex, InIndex, Instrument> const& g,
+	              std::type_identity_t<N> const& src,
+	              Visit visit,
+	              search_workspace<N, E>& ws,
+	              std::type_identity_t<E> const& unweighted_cost = E{1}) -> N const* {
+		return detail::search::dijkstra(g, src, visit, ws, unweighted_cost);
+	}
+
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument, typename Visit>
+	auto dijkstra(graph<N, E, NodeIndex, InIndex, Instrument> const& g, std::type_identity_t<N> const& src, Visit visit)
+	    -> N const* {
+		auto ws = search_workspace<N, E>{};
+		return detail::search::dijkstra(g, src, visit, ws, E{1});
+	}
+
+	// Orders the nodes so every edge goes from an earlier node to a later one, nodes that become ready
+	// together keep ascending order. Throws if the graph has a cycle, a self loop is one
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+	auto topological_sort(graph<N, E, NodeIndex, InIndex, Instrument> const& g, search_workspace<N, E>& ws)
+	    -> std::vector<N> {
+		return detail::search::topological_sort(g, ws);
+	}
+
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+	auto topological_sort(graph<N, E, NodeIndex, InIndex, Instrument> const& g) -> std::vector<N> {
+		auto ws = search_workspace<N, E>{};
+		return detail::search::topological_sort(g, ws);
+	}
+} // namespace gdwg
+
+#endif // GDWG_ALGORITHM_H
@@ -0,0 +1,130 @@
+#include "gdwg_algorithm.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+	// A -> B -> D -> E, A -> C -> D with weights making A C D the shorter way, F unreachable
+	auto make_graph() -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D", "E", "F"};
+		g.insert_edge("A", "B", 1);
+		g.insert_edge("A", "C", 2);
+		g.insert_edge("B", "D", 5);
+		g.insert_edge("B", "D", 9);
+		g.insert_edge("C", "D", 1);
+		g.insert_edge("D", "E");
+		return g;
+	}
+} // namespace
+
+TEST_CASE("bfs") {
+	auto g = make_graph();
+	auto seen = std::vector<std::string>{};
+	SECTION("visits in order of hops") {
+		CHECK(gdwg::bfs(g, "A", [&](auto const& n) { seen.push_back(n); }) == nullptr);
+		CHECK(seen == std::vector<std::string>{"A", "B", "C", "D", "E"});
+	}
+	SECTION("stops early and keeps the path") {
+		auto ws = gdwg::search_workspace<std::string, int>{};
+		auto found = gdwg::bfs(g, "A", [](auto const& n) { return n == "D"; }, ws);
+		REQUIRE(found != nullptr);
+		CHECK(*found == "D");
+		CHECK(ws.path_to(*found) == std::vector<std::string>{"A", "B", "D"});
+		CHECK_FALSE(ws.reached(*g.find_node("E")));
+	}
+	SECTION("a missing src throws") {
+		try {
+			gdwg::bfs(g, "X", [](auto const&) {});
+			FAIL("bfs should have thrown");
+		} catch (std::runtime_error const& e) {
+			CHECK(std::string{e.what()} == "Cannot call gdwg::bfs if src doesn't exist in the graph");
+		}
+	}
+}
+
+TEST_CASE("dfs") {
+	auto g = make_graph();
+	g.insert_edge("E", "A");
+	auto seen = std::vector<std::string>{};
+	CHECK(gdwg::dfs(g, "A", [&](auto const& n) { seen.push_back(n); }) == nullptr);
+	CHECK(seen == std::vector<std::string>{"A", "B", "D", "E", "C"});
+	auto ws = gdwg::search_workspace<std::string, int>{};
+	auto found = gdwg::dfs(g, "A", [](auto const& n) { return n == "C"; }, ws);
+	REQUIRE(found != nullptr);
+	CHECK(ws.path_to(*found) == std::vector<std::string>{"A", "C"});
+}
+
+TEST_CASE("dijkstra") {
+	auto g = make_graph();
+	auto ws = gdwg::search_workspace<std::string, int>{};
+	auto distances = std::vector<std::pair<std::string, int>>{};
+	auto record = [&](auto const& n, int d) { distances.emplace_back(n, d); };
+
+	SECTION("unweighted edges cost one by default") {
+		CHECK(gdwg::dijkstra(g, "A", record, ws) == nullptr);
+		CHECK(distances == std::vector<std::pair<std::string, int>>{{"A", 0}, {"B", 1}, {"C", 2}, {"D", 3}, {"E", 4}});
+		CHECK(ws.path_to(*g.find_node("E")) == std::vector<std::string>{"A", "C", "D", "E"});
+		CHECK(ws.path_to(*g.find_node("F")).empty());
+	}
+	SECTION("the unweighted cost can be chosen") {
+		gdwg::dijkstra(g, "A", record, ws, 10);
+		CHECK(distances.back() == std::pair<std::string, int>{"E", 13});
+	}
+	SECTION("stops once the target is settled") {
+		auto found = gdwg::dijkstra(g, "A", [](auto const& n, int) { return n == "D"; }, ws);
+		REQUIRE(found != nullptr);
+		CHECK(ws.path_to(*found) == std::vector<std::string>{"A", "C", "D"});
+		CHECK_FALSE(ws.reached(*g.find_node("E")));
+	}
+	SECTION("a workspace can be reused") {
+		for (auto i = 0; i < 3; ++i) {
+			distances.clear();
+			gdwg::dijkstra(g, "B", record, ws);
+			CHECK(distances == std::vector<std::pair<std::string, int>>{{"B", 0}, {"D", 5}, {"E", 6}});
+			CHECK_FALSE(ws.reached(*g.find_node("A")));
+		}
+	}
+	SECTION("negative weights throw") {
+		g.insert_edge("A", "F", -1);
+		CHECK_THROWS_WITH(gdwg::dijkstra(g, "A", record, ws),
+		                  "Cannot call gdwg::dijkstra on a graph with negative weights");
+	}
+}
+
+TEST_CASE("topological_sort") {
+	auto g = make_graph();
+	CHECK(gdwg::topological_sort(g) == std::vector<std::string>{"A", "F", "B", "C", "D", "E"});
+	SECTION("a large graph grows the workspace") {
+		auto big = gdwg::graph<int, int>{};
+		for (auto i = 0; i < 1000; ++i) {
+			big.insert_node(i);
+		}
+		for (auto i = 1; i < 1000; ++i) {
+			big.insert_edge(i - 1, i);
+		}
+		auto ws = gdwg::search_workspace<int, int>{};
+		auto order = gdwg::topological_sort(big, ws);
+		CHECK(order.size() == 1000);
+		CHECK(std::is_sorted(order.begin(), order.end()));
+	}
+	SECTION("graphs without weights") {
+		auto unweighted = gdwg::graph<std::string, void>{"A", "B", "C"};
+		unweighted.insert_edge("C", "A");
+		unweighted.insert_edge("A", "B");
+		CHECK(gdwg::topological_sort(unweighted) == std::vector<std::string>{"C", "A", "B"});
+		auto seen = std::vector<std::string>{};
+		CHECK(gdwg::bfs(unweighted, "C", [&](auto const& n) { seen.push_back(n); }) == nullptr);
+		CHECK(seen == std::vector<std::string>{"C", "A", "B"});
+	}
+	SECTION("a cycle throws") {
+		g.insert_edge("E", "B");
+		try {
+			gdwg::topological_sort(g);
+			FAIL("topological_sort should have thrown");
+		} catch (std::runtime_error const& e) {
+			CHECK(std::string{e.what()} == "Cannot call gdwg::topological_sort on a graph with a cycle");
+		}
+	}
+}
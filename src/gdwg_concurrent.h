@@ -0,0 +1,145 @@
+#ifndef GDWG_CONCURRENT_H
+#	define GDWG_CONCURRENT_H
+
+#	include "gdwg_graph.h"
+
+#	include <atomic>
+#	include <memory>
+#	include <mutex>
+#	include <shared_mutex>
+#	include <type_traits>
+#	include <utility>
+#	include <vector>
+
+namespace gdwg {
+	// Thread safe wrapper around a graph. Readers share a std::shared_mutex and only wait for a
+	// writer that is modifying the graph in place. A snapshot() is an immutable version of the graph
+	// that needs no lock at all: while any snapshot of the current version is alive, the next write
+	// copies the graph and modifies the copy, so the snapshot never sees a change.
+	template<typename N,
+	         typename E,
+	         typename NodeIndex = ordered_node_index<N>,
+	         typename InIndex = no_in_edge_index<N, E>,
+	         typename Instrument = no_instrumentation>
+	class concurrent_graph {
+	 public:
+		using graph_type = graph<N, E, NodeIndex, InIndex, Instrument>;
+		using snapshot_type = std::shared_ptr<graph_type const>;
+
+		// constructors
+		concurrent_graph()
+		: current_{std::make_shared<graph_type>()} {}
+
+		explicit concurrent_graph(graph_type g)
+		: current_{std::make_shared<graph_type>(std::move(g))} {}
+
+		concurrent_graph(concurrent_graph const&) = delete;
+		auto operator=(concurrent_graph const&) -> concurrent_graph& = delete;
+		~concurrent_graph() = default;
+
+		// consistent version of the graph that stays valid and unchanged while writers carry on
+		[[nodiscard]] auto snapshot() const -> snapshot_type {
+			auto lock = std::shared_lock{mutex_};
+			return current_;
+		}
+
+		// runs f(graph const&) under the shared lock
+		template<typename F>
+		auto read(F&& f) const -> decltype(auto) {
+			auto lock = std::shared_lock{mutex_};
+			return std::forward<F>(f)(std::as_const(*current_));
+		}
+
+		// runs f(graph&) under the exclusive lock, many modifications pay for one copy at most. If f
+		// throws after the graph had to be copied for outstanding snapshots, the copy is dropped and
+		// the graph is left as it was
+		template<typename F>
+		auto write(F&& f) -> decltype(auto) {
+			auto lock = std::unique_lock{mutex_};
+			// snapshots are only taken under the shared lock, so none can appear while we hold this one
+			if (current_.use_count() > 1) {
+				auto copy = std::make_shared<graph_type>(*current_, current_->get_allocator());
+				if constexpr (std::is_void_v<decltype(std::forward<F>(f)(*copy))>) {
+					std::forward<F>(f)(*copy);
+					current_ = std::move(copy);
+				}
+				else {
+					decltype(auto) res = std::forward<F>(f)(*copy);
+					current_ = std::move(copy);
+					return res;
+				}
+			}
+			else {
+				// use_count() is a relaxed load, the fence orders our writes after every read made
+				// through the snapshot whose release brought the count down to one
+				std::atomic_thread_fence(std::memory_order_acquire);
+				return std::forward<F>(f)(*current_);
+			}
+		}
+
+		// modifiers
+		auto insert_node(N const& value) -> bool {
+			return write([&](graph_type& g) { return g.insert_node(value); });
+		}
+
+		auto insert_edge(N const& src, N const& dst, weight_t<E> weight = {}) -> bool {
+			return write([&](graph_type& g) { return g.insert_edge(src, dst, weight); });
+		}
+
+		template<typename InputIt>
+		auto insert_edges(InputIt first, InputIt last) -> std::size_t {
+			return write([&](graph_type& g) { return g.insert_edges(first, last); });
+		}
+
+		auto replace_node(N const& old_data, N const& new_data) -> bool {
+			return write([&](graph_type& g) { return g.replace_node(old_data, new_data); });
+		}
+
+		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
+			write([&](graph_type& g) { g.merge_replace_node(old_data, new_data); });
+		}
+
+		auto erase_node(N const& value) -> bool {
+			return write([&](graph_type& g) { return g.erase_node(value); });
+		}
+
+		auto erase_edge(N const& src, N const& dst, weight_t<E> weight = {}) -> bool {
+			return write([&](graph_type& g) { return g.erase_edge(src, dst, weight); });
+		}
+
+		auto clear() -> void {
+			write([](graph_type& g) { g.clear(); });
+		}
+
+		// accessors
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return read([&](graph_type const& g) { return g.is_node(value); });
+		}
+
+		[[nodiscard]] auto empty() const -> bool {
+			return read([](graph_type const& g) { return g.empty(); });
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			return read([&](graph_type const& g) { return g.is_connected(src, dst); });
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			return read([](graph_type const& g) { return g.nodes(); });
+		}
+
+		[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<typename graph_type::edge> {
+			return read([&](graph_type const& g) { return g.edges(src, dst); });
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			return read([&](graph_type const& g) { return g.connections(src); });
+		}
+
+	 private:
+		mutable std::shared_mutex mutex_;
+		std::shared_ptr<graph_type> current_;
+	};
+} // namespace gdwg
+
+#endif // GDWG_CONCURRENT_H
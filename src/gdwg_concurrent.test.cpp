@@ -0,0 +1,146 @@
+#include "gdwg_concurrent.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Constructor works as expected") {
+	SECTION("default constructor") {
+		auto g = gdwg::concurrent_graph<std::string, int>{};
+		CHECK(g.empty());
+		CHECK(g.snapshot()->empty());
+	}
+	SECTION("wrapping a graph") {
+		auto base = gdwg::graph<std::string, int>{"A", "B"};
+		base.insert_edge("A", "B", 1);
+		auto g = gdwg::concurrent_graph<std::string, int>{base};
+		CHECK(*g.snapshot() == base);
+		CHECK(g.is_connected("A", "B"));
+	}
+}
+
+TEST_CASE("Modifiers and accessors forward to the graph") {
+	auto g = gdwg::concurrent_graph<std::string, int>{};
+	CHECK(g.insert_node("A"));
+	CHECK(g.insert_node("B"));
+	CHECK_FALSE(g.insert_node("A"));
+	CHECK(g.insert_edge("A", "B", 2));
+	CHECK(g.insert_edge("A", "A"));
+	CHECK(g.nodes() == std::vector<std::string>{"A", "B"});
+	CHECK(g.connections("A") == std::vector<std::string>{"A", "B"});
+	CHECK(g.edges("A", "B").size() == 1);
+	CHECK(g.replace_node("B", "C"));
+	CHECK(g.is_connected("A", "C"));
+	CHECK(g.erase_edge("A", "C", 2));
+	CHECK(g.erase_node("A"));
+	CHECK(g.nodes() == std::vector<std::string>{"C"});
+	g.clear();
+	CHECK(g.empty());
+
+	SECTION("errors from the graph reach the caller") {
+		try {
+			g.insert_edge("X", "Y", 1);
+			FAIL("insert_edge should have thrown");
+		} catch (std::runtime_error const& e) {
+			CHECK(std::string{e.what()}
+			      == "Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist");
+		}
+	}
+}
+
+TEST_CASE("Snapshots are unaffected by later writes") {
+	auto g = gdwg::concurrent_graph<std::string, int>{};
+	g.insert_node("A");
+	auto before = g.snapshot();
+	g.insert_node("B");
+	g.insert_edge("A", "B", 1);
+	CHECK(before->nodes() == std::vector<std::string>{"A"});
+	CHECK(g.snapshot()->nodes() == std::vector<std::string>{"A", "B"});
+
+	SECTION("a throwing write leaves the snapshotted version in place") {
+		auto held = g.snapshot();
+		try {
+			g.write([](auto& graph) {
+				graph.insert_node("C");
+				graph.insert_edge("C", "X", 1);
+			});
+			FAIL("write should have thrown");
+		} catch (std::runtime_error const&) {
+		}
+		CHECK_FALSE(g.is_node("C"));
+		CHECK(g.snapshot() == held);
+	}
+	SECTION("write returns the value of the callable") {
+		auto n = g.write([](auto& graph) { return graph.insert_node("C") and graph.insert_node("D"); });
+		CHECK(n);
+		CHECK(g.read([](auto const& graph) { return graph.nodes().size(); }) == 4);
+	}
+}
+
+TEST_CASE("Readers and writers can run at the same time") {
+	auto g = gdwg::concurrent_graph<int, int>{};
+	constexpr auto writes = 200;
+	auto done = std::atomic<bool>{false};
+	auto readers = std::vector<std::thread>{};
+	auto consistent = std::atomic<bool>{true};
+	for (auto i = 0; i < 3; ++i) {
+		readers.emplace_back([&] {
+			while (not done) {
+				// every write adds a node and an edge from it, a snapshot must always see both or neither
+				auto snap = g.snapshot();
+				for (auto const& n : snap->nodes()) {
+					if (n > 0 and not snap->is_connected(n, n - 1)) {
+						consistent = false;
+					}
+				}
+			}
+		});
+	}
+	g.insert_node(0);
+	for (auto i = 1; i <= writes; ++i) {
+		g.write([i](auto& graph) {
+			graph.insert_node(i);
+			graph.insert_edge(i, i - 1, i);
+		});
+	}
+	done = true;
+	for (auto& t : readers) {
+		t.join();
+	}
+	CHECK(consistent);
+	CHECK(g.nodes().size() == writes + 1);
+}
+
+TEST_CASE("Copies of a graph can be modified on different threads") {
+	auto base = gdwg::graph<int, int>{};
+	for (auto i = 0; i < 100; ++i) {
+		base.insert_node(i);
+	}
+	for (auto i = 1; i < 100; ++i) {
+		base.insert_edge(i, i - 1, i);
+	}
+	auto ok = std::atomic<bool>{true};
+	auto workers = std::vector<std::thread>{};
+	for (auto t = 0; t < 4; ++t) {
+		// every worker gets a copy that shares base's storage until it modifies it
+		workers.emplace_back([copy = base, t, &ok]() mutable {
+			for (auto i = 0; i < 50; ++i) {
+				copy.insert_edge(i, i + 1, t);
+				copy.erase_node(99 - i);
+			}
+			if (copy.nodes().size() != 50 or not copy.is_connected(0, 1)) {
+				ok = false;
+			}
+		});
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+	CHECK(ok);
+	CHECK(base.nodes().size() == 100);
+	CHECK(base.edges(1, 0).size() == 1);
+	CHECK(not base.is_connected(0, 1));
+}
@@ -0,0 +1,415 @@
+#ifndef GDWG_CSR_H
+#	define GDWG_CSR_H
+
+#	include "gdwg_graph.h"
+#	include "gdwg_simd.h"
+
+#	include <algorithm>
+#	include <cstdint>
+#	include <iterator>
+#	include <limits>
+#	include <memory>
+#	include <numeric>
+#	include <optional>
+#	include <ostream>
+#	include <span>
+#	include <stdexcept>
+#	include <string>
+#	include <vector>
+
+namespace gdwg {
+	// Immutable compressed sparse row snapshot of a graph. Nodes are kept in a sorted array and
+	// referred to by their index in it, the outgoing edges of node i are the packed destinations
+	// and weights in [offsets()[i], offsets()[i + 1]). Every member is const, so one snapshot can
+	// be read from any number of threads without locking.
+	//
+	// The arrays are views over storage shared by every copy of the snapshot, either owned by the
+	// snapshot itself or by someone else, e.g. a memory mapped file (see gdwg_io.h).
+	template<typename N, typename E>
+	class csr_graph {
+		class iterator;
+
+	 public:
+		using node_id = std::uint32_t;
+		using edge = typename graph<N, E>::edge;
+
+		// the arrays a snapshot owns when it isn't viewing external storage
+		struct arrays {
+			std::vector<N> nodes;
+			std::vector<std::size_t> offsets;
+			std::vector<node_id> dsts;
+			std::vector<weight_t<E>> weights;
+		};
+
+		// constructors
+		csr_graph()
+		: csr_graph(arrays{{}, {0}, {}, {}}) {}
+
+		template<typename NodeIndex, typename InIndex, typename Instrument>
+		explicit csr_graph(graph<N, E, NodeIndex, InIndex, Instrument> const& g)
+		: csr_graph(build(g)) {}
+
+		// takes ownership of arrays that already form a valid CSR, nodes sorted and unique,
+		// offsets of size nodes + 1 ending at dsts.size(), and each row of dsts sorted
+		explicit csr_graph(arrays a) {
+			auto owned = std::make_shared<arrays const>(std::move(a));
+			nodes_ = owned->nodes;
+			offsets_ = owned->offsets;
+			dsts_ = owned->dsts;
+			weights_ = owned->weights;
+			storage_ = std::move(owned);
+		}
+
+		// views arrays that live in storage, which must keep them alive and unchanged
+		csr_graph(std::shared_ptr<void const> storage,
+		          std::span<N const> nodes,
+		          std::span<std::size_t const> offsets,
+		          std::span<node_id const> dsts,
+		          std::span<weight_t<E> const> weights)
+		: storage_{std::move(storage)}
+		, nodes_{nodes}
+		, offsets_{offsets}
+		, dsts_{dsts}
+		, weights_{weights} {}
+
+		// accessors
+		[[nodiscard]] auto is_node(N const& value) const noexcept -> bool {
+			return std::binary_search(nodes_.begin(), nodes_.end(), value);
+		}
+
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return nodes_.empty();
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			if (is_node(src) and is_node(dst)) {
+				auto range = edge_range(id_of(src), id_of(dst));
+				return range.first != range.second;
+			}
+			auto emsg = std::string{"Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst node don't exist "
+			                        "in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		[[nodiscard]] auto nodes() const noexcept -> std::span<N const> {
+			return nodes_;
+		}
+
+		[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<edge> {
+			if (is_node(src) and is_node(dst)) {
+				auto res = std::vector<edge>{};
+				auto range = edge_range(id_of(src), id_of(dst));
+				for (auto e = range.first; e != range.second; ++e) {
+					res.push_back(edge_handle<N, E>{src, dst, weights_[e]});
+				}
+				return res;
+			}
+			auto emsg = std::string{"Cannot call gdwg::csr_graph<N, E>::edges if src or dst node don't exist in the "
+			                        "graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			if (is_node(src)) {
+				auto res = std::vector<N>{};
+				for (auto dst : neighbours(id_of(src))) {
+					if (res.empty() or res.back() != nodes_[dst]) {
+						res.push_back(nodes_[dst]);
+					}
+				}
+				return res;
+			}
+			auto emsg = std::string{"Cannot call gdwg::csr_graph<N, E>::connections if src doesn't exist in the "
+			                        "graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the nodes that both a and b have an edge to, in order
+		[[nodiscard]] auto common_neighbours(N const& a, N const& b) const -> std::vector<N> {
+			if (is_node(a) and is_node(b)) {
+				auto res = std::vector<N>{};
+				for (auto id : common_neighbours(id_of(a), id_of(b))) {
+					res.push_back(nodes_[id]);
+				}
+				return res;
+			}
+			auto emsg = std::string{"Cannot call gdwg::csr_graph<N, E>::common_neighbours if a or b node don't exist "
+			                        "in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the number of sets of three nodes that are each connected to the other two, by an edge in
+		// either direction. Self loops and repeated edges count once at most. Every pair of connected
+		// nodes is kept once, pointing from the node with fewer neighbours, so a triangle is found
+		// once and no node has to intersect a long list of its own
+		[[nodiscard]] auto triangle_count() const -> std::size_t {
+			auto const n = nodes_.size();
+			auto pairs = std::vector<std::uint64_t>{};
+			pairs.reserve(dsts_.size());
+			for (auto src = node_id{0}; src < n; ++src) {
+				for (auto dst : neighbours(src)) {
+					if (src != dst) {
+						auto [lo, hi] = std::minmax(src, dst);
+						pairs.push_back((std::uint64_t{lo} << 32) | hi);
+					}
+				}
+			}
+			std::sort(pairs.begin(), pairs.end());
+			pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+			auto first = [](std::uint64_t pair) { return static_cast<node_id>(pair >> 32); };
+			auto second = [](std::uint64_t pair) { return static_cast<node_id>(pair); };
+
+			auto degree = std::vector<std::size_t>(n, 0);
+			for (auto pair : pairs) {
+				++degree[first(pair)];
+				++degree[second(pair)];
+			}
+			auto order = std::vector<node_id>(n);
+			std::iota(order.begin(), order.end(), node_id{0});
+			std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) { return degree[a] < degree[b]; });
+			auto rank = std::vector<node_id>(n);
+			for (auto r = node_id{0}; r < n; ++r) {
+				rank[order[r]] = r;
+			}
+
+			// the pairs as rows of a CSR over ranks, every edge from the lower rank to the higher
+			auto offsets = std::vector<std::size_t>(n + 1, 0);
+			for (auto pair : pairs) {
+				++offsets[std::min(rank[first(pair)], rank[second(pair)]) + 1];
+			}
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+			auto higher = std::vector<node_id>(pairs.size());
+			auto fill = std::vector<std::size_t>(offsets.begin(), offsets.end() - 1);
+			for (auto pair : pairs) {
+				auto [lo, hi] = std::minmax(rank[first(pair)], rank[second(pair)]);
+				higher[fill[lo]++] = hi;
+			}
+			auto row = [&](node_id r) {
+				return std::span<node_id const>{higher}.subspan(offsets[r], offsets[r + 1] - offsets[r]);
+			};
+			for (auto r = node_id{0}; r < n; ++r) {
+				std::sort(higher.begin() + static_cast<std::ptrdiff_t>(offsets[r]),
+				          higher.begin() + static_cast<std::ptrdiff_t>(offsets[r + 1]));
+			}
+
+			auto count = std::size_t{0};
+			for (auto r = node_id{0}; r < n; ++r) {
+				for (auto s : row(r)) {
+					count += detail::simd::intersect_count(row(r), row(s));
+				}
+			}
+			return count;
+		}
+
+		// Raw CSR access, for algorithms working on node ids
+		[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+			return nodes_.size();
+		}
+
+		[[nodiscard]] auto num_edges() const noexcept -> std::size_t {
+			return dsts_.size();
+		}
+
+		[[nodiscard]] auto id(N const& value) const noexcept -> std::optional<node_id> {
+			if (is_node(value)) {
+				return id_of(value);
+			}
+			return std::nullopt;
+		}
+
+		[[nodiscard]] auto node(node_id id) const noexcept -> N const& {
+			return nodes_[id];
+		}
+
+		[[nodiscard]] auto offsets() const noexcept -> std::span<std::size_t const> {
+			return offsets_;
+		}
+
+		[[nodiscard]] auto destinations() const noexcept -> std::span<node_id const> {
+			return dsts_;
+		}
+
+		[[nodiscard]] auto weights() const noexcept -> std::span<weight_t<E> const> {
+			return weights_;
+		}
+
+		[[nodiscard]] auto neighbours(node_id src) const noexcept -> std::span<node_id const> {
+			return dsts_.subspan(offsets_[src], offsets_[src + 1] - offsets_[src]);
+		}
+
+		[[nodiscard]] auto weights(node_id src) const noexcept -> std::span<weight_t<E> const> {
+			return weights_.subspan(offsets_[src], offsets_[src + 1] - offsets_[src]);
+		}
+
+		// the ids both a and b have an edge to, in order, found by a vectorised merge of their rows
+		[[nodiscard]] auto common_neighbours(node_id a, node_id b) const -> std::vector<node_id> {
+			auto res = std::vector<node_id>{};
+			detail::simd::intersect(neighbours(a), neighbours(b), res);
+			return res;
+		}
+
+		// Iterator Access
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator(this, 0, 0);
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator(this, nodes_.size(), dsts_.size());
+		}
+
+		// Comparisons
+		[[nodiscard]] auto operator==(csr_graph const& other) const noexcept -> bool {
+			return std::ranges::equal(nodes_, other.nodes_) and std::ranges::equal(offsets_, other.offsets_)
+			       and std::ranges::equal(dsts_, other.dsts_) and std::ranges::equal(weights_, other.weights_);
+		}
+
+		// Extractor
+		friend auto operator<<(std::ostream& os, csr_graph const& g) noexcept -> std::ostream& {
+			os << "\n";
+			for (auto src = node_id{0}; src < g.nodes_.size(); ++src) {
+				os << g.nodes_[src] << " (\n";
+				for (auto e = g.offsets_[src]; e != g.offsets_[src + 1]; ++e) {
+					os << "  ";
+					write_edge(os, g.nodes_[src], g.nodes_[g.dsts_[e]], g.weights_[e]);
+					os << "\n";
+				}
+				os << ")\n";
+			}
+			return os;
+		}
+
+	 private:
+		std::shared_ptr<void const> storage_;
+		std::span<N const> nodes_;
+		std::span<std::size_t const> offsets_;
+		std::span<node_id const> dsts_;
+		std::span<weight_t<E> const> weights_;
+
+		template<typename NodeIndex, typename InIndex, typename Instrument>
+		static auto build(graph<N, E, NodeIndex, InIndex, Instrument> const& g) -> arrays {
+			auto a = arrays{g.nodes(), {}, {}, {}};
+			a.offsets.assign(a.nodes.size() + 1, 0);
+			if (a.nodes.size() > std::numeric_limits<node_id>::max()) {
+				auto emsg = std::string{"Cannot call gdwg::csr_graph<N, E>::csr_graph on a graph with more nodes "
+				                        "than node_id can index"};
+				throw std::runtime_error{emsg};
+			}
+			// edges of g come ordered by src, so the row of each edge only ever moves forward
+			auto row = std::size_t{0};
+			for (auto const& [from, to, weight] : g) {
+				while (a.nodes[row] != from) {
+					a.offsets[++row] = a.dsts.size();
+				}
+				auto dst = std::lower_bound(a.nodes.begin(), a.nodes.end(), to);
+				a.dsts.push_back(static_cast<node_id>(dst - a.nodes.begin()));
+				a.weights.push_back(weight);
+			}
+			while (row < a.nodes.size()) {
+				a.offsets[++row] = a.dsts.size();
+			}
+			return a;
+		}
+
+		// only valid for values known to be nodes
+		auto id_of(N const& value) const noexcept -> node_id {
+			auto it = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+			return static_cast<node_id>(it - nodes_.begin());
+		}
+
+		// helper function for binary searching the row of src for the edges to dst
+		auto edge_range(node_id src, node_id dst) const noexcept -> std::pair<std::size_t, std::size_t> {
+			auto row = neighbours(src);
+			auto range = std::equal_range(row.begin(), row.end(), dst);
+			auto first = offsets_[src] + static_cast<std::size_t>(range.first - row.begin());
+			auto last = offsets_[src] + static_cast<std::size_t>(range.second - row.begin());
+			return {first, last};
+		}
+	};
+
+	template<typename N, typename E>
+	class csr_graph<N, E>::iterator {
+	 public:
+		struct value_type {
+			N from;
+			N to;
+			weight_t<E> weight;
+		};
+
+		// refers into the arrays, so dereferencing copies neither the nodes nor the weight
+		struct reference {
+			N const& from;
+			N const& to;
+			weight_t<E> const& weight;
+
+			operator value_type() const {
+				return value_type{from, to, weight};
+			}
+		};
+
+		using pointer = void;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::bidirectional_iterator_tag;
+
+		// Iterator constructor
+		iterator() = default;
+
+		// Iterator source
+		auto operator*() const noexcept -> reference {
+			return reference{g_->nodes_[row_], g_->nodes_[g_->dsts_[curr_]], g_->weights_[curr_]};
+		}
+
+		// Iterator traversal
+		auto operator++() noexcept -> iterator& {
+			++curr_;
+			skip_forward();
+			return *this;
+		}
+
+		auto operator++(int) noexcept -> iterator {
+			auto copy{*this};
+			++(*this);
+			return copy;
+		}
+
+		auto operator--() noexcept -> iterator& {
+			--curr_;
+			while (g_->offsets_[row_] > curr_) {
+				--row_;
+			}
+			return *this;
+		}
+
+		auto operator--(int) noexcept -> iterator {
+			auto copy{*this};
+			--(*this);
+			return copy;
+		}
+
+		// Iterator comparison
+		auto operator==(iterator const& other) const noexcept -> bool {
+			return curr_ == other.curr_;
+		}
+
+	 private:
+		iterator(csr_graph const* g, std::size_t row, std::size_t curr)
+		: g_(g)
+		, row_(row)
+		, curr_(curr) {
+			skip_forward();
+		}
+
+		// moves row_ onto the node owning the edge at curr_, past any node without edges
+		void skip_forward() noexcept {
+			while (row_ < g_->nodes_.size() and g_->offsets_[row_ + 1] <= curr_) {
+				++row_;
+			}
+		}
+
+		csr_graph const* g_{};
+		std::size_t row_{};
+		std::size_t curr_{};
+		friend class csr_graph<N, E>;
+	};
+} // namespace gdwg
+
+#endif // GDWG_CSR_H
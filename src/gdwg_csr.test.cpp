@@ -0,0 +1,225 @@
+#include "gdwg_csr.h"
+
+#include <catch2/catch.hpp>
+
+namespace {
+	auto make_graph() -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D", "E"};
+		g.insert_edge("A", "B", 3);
+		g.insert_edge("A", "B");
+		g.insert_edge("A", "D", 1);
+		g.insert_edge("C", "A", 2);
+		g.insert_edge("D", "D", 4);
+		return g;
+	}
+} // namespace
+
+TEST_CASE("Constructor works as expected") {
+	SECTION("default constructor") {
+		auto c = gdwg::csr_graph<std::string, int>{};
+		CHECK(c.empty());
+		CHECK(c.begin() == c.end());
+	}
+	SECTION("snapshot of a graph") {
+		auto g = make_graph();
+		auto c = gdwg::csr_graph<std::string, int>{g};
+		CHECK(c.num_nodes() == 5);
+		CHECK(c.num_edges() == 5);
+		CHECK(std::ranges::equal(c.nodes(), g.nodes()));
+		// the snapshot doesn't follow later changes to the graph
+		g.insert_edge("E", "A", 9);
+		CHECK(not c.is_connected("E", "A"));
+	}
+}
+
+TEST_CASE("Snapshots of graphs without weights") {
+	auto g = gdwg::graph<int, void>{1, 2, 3};
+	g.insert_edge(1, 2);
+	g.insert_edge(1, 3);
+	g.insert_edge(3, 3);
+	auto c = gdwg::csr_graph<int, void>{g};
+	CHECK(c.num_edges() == 3);
+	CHECK(c.is_connected(1, 3));
+	CHECK(c.connections(1) == std::vector<int>{2, 3});
+	CHECK(c.edges(3, 3).front()->print_edge() == "3 -> 3 | U");
+	CHECK(c == gdwg::csr_graph<int, void>{g});
+	auto out = std::ostringstream{};
+	auto expected = std::ostringstream{};
+	out << c;
+	expected << g;
+	CHECK(out.str() == expected.str());
+	CHECK(std::ranges::equal(c, g, [](auto const& a, auto const& b) { return a.from == b.from and a.to == b.to; }));
+}
+
+TEST_CASE("Accessors work as expected") {
+	auto g = make_graph();
+	auto c = gdwg::csr_graph<std::string, int>{g};
+	SECTION("is_node") {
+		CHECK(c.is_node("E"));
+		CHECK(not c.is_node("T"));
+	}
+	SECTION("is_connected") {
+		try {
+			(void)c.is_connected("X", "T");
+		} catch (const std::runtime_error& e) {
+			CHECK(std::string(e.what())
+			      == "Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+		} catch (...) {
+			CHECK(false);
+		}
+		CHECK(c.is_connected("A", "D"));
+		CHECK(not c.is_connected("D", "A"));
+	}
+	SECTION("edges") {
+		auto e = c.edges("A", "B");
+		CHECK(e.size() == 2);
+		CHECK(e[0]->print_edge() == "A -> B | U");
+		CHECK(e[1]->print_edge() == "A -> B | W | 3");
+		CHECK(c.edges("B", "A").empty());
+	}
+	SECTION("connections") {
+		CHECK(c.connections("A") == std::vector<std::string>{"B", "D"});
+		CHECK(c.connections("B").empty());
+		CHECK(c.connections("A") == g.connections("A"));
+	}
+	SECTION("node ids") {
+		auto a = c.id("A");
+		REQUIRE(a.has_value());
+		CHECK(c.node(*a) == "A");
+		CHECK(c.neighbours(*a).size() == 3);
+		CHECK(c.weights(*a)[0] == std::nullopt);
+		CHECK(c.id("T") == std::nullopt);
+	}
+}
+
+TEST_CASE("Comparisons and extractor") {
+	auto g = make_graph();
+	auto c = gdwg::csr_graph<std::string, int>{g};
+	CHECK(c == gdwg::csr_graph<std::string, int>{g});
+	g.erase_node("D");
+	CHECK(c != gdwg::csr_graph<std::string, int>{g});
+
+	auto out = std::ostringstream{};
+	out << c;
+	auto expected = std::ostringstream{};
+	expected << make_graph();
+	CHECK(out.str() == expected.str());
+}
+
+TEST_CASE("Iterator") {
+	auto g = make_graph();
+	auto c = gdwg::csr_graph<std::string, int>{g};
+	auto out = std::ostringstream{};
+	for (auto const& [from, to, weight] : c) {
+		out << from << to << weight.value_or(0) << " ";
+	}
+	CHECK(out.str() == "AB0 AB3 AD1 CA2 DD4 ");
+	auto it = c.end();
+	--it;
+	auto const& [f, t, w] = *it;
+	CHECK((f == "D" and t == "D" and w == 4));
+	--it;
+	--it;
+	CHECK((*it).from == "A");
+	// dereferencing refers into the arrays rather than copying out of them
+	static_assert(std::bidirectional_iterator<decltype(c.begin())>);
+	CHECK(&(*c.begin()).from == &c.nodes().front());
+	CHECK(&(*c.begin()).weight == &c.weights().front());
+	decltype(c.begin())::value_type copy = *it;
+	CHECK((copy.from == "A" and copy.to == "D" and copy.weight == 1));
+}
+
+TEST_CASE("Common neighbours and triangles") {
+	auto state = 41U;
+	auto roll = [&state](unsigned bound) {
+		state = state * 1103515245U + 12345U;
+		return (state >> 8) % bound;
+	};
+
+	SECTION("common_neighbours") {
+		auto c = gdwg::csr_graph<std::string, int>{make_graph()};
+		CHECK(c.common_neighbours("A", "D") == std::vector<std::string>{"D"});
+		CHECK(c.common_neighbours("A", "A") == std::vector<std::string>{"B", "D"});
+		CHECK(c.common_neighbours("A", "C").empty());
+		CHECK_THROWS_WITH(c.common_neighbours("A", "T"),
+		                  "Cannot call gdwg::csr_graph<N, E>::common_neighbours if a or b node don't exist in the "
+		                  "graph");
+	}
+	SECTION("triangle_count ignores direction, self loops and repeated edges") {
+		auto g = gdwg::graph<int, int>{1, 2, 3, 4};
+		g.insert_edge(1, 2, 1);
+		g.insert_edge(1, 2, 2);
+		g.insert_edge(3, 2);
+		g.insert_edge(1, 3);
+		g.insert_edge(3, 1);
+		g.insert_edge(4, 4);
+		g.insert_edge(4, 1);
+		CHECK(gdwg::csr_graph<int, int>{g}.triangle_count() == 1);
+		g.insert_edge(2, 4);
+		CHECK(gdwg::csr_graph<int, int>{g}.triangle_count() == 2);
+		CHECK(gdwg::csr_graph<int, int>{}.triangle_count() == 0);
+	}
+	SECTION("random graphs agree with the naive answers") {
+		for (auto round = 0; round < 5; ++round) {
+			auto g = gdwg::graph<int, int>{};
+			auto const n = 60 + round * 20;
+			for (auto i = 0; i < n; ++i) {
+				g.insert_node(i);
+			}
+			for (auto i = 0; i < n * 8; ++i) {
+				// a few hubs give the skewed intersections
+				auto src = static_cast<int>(roll(4) == 0 ? roll(3) : roll(static_cast<unsigned>(n)));
+				g.insert_edge(src, static_cast<int>(roll(static_cast<unsigned>(n))), static_cast<int>(roll(2)));
+			}
+			auto c = gdwg::csr_graph<int, int>{g};
+			auto linked = [&](int a, int b) { return g.is_connected(a, b) or g.is_connected(b, a); };
+			auto triangles = std::size_t{0};
+			for (auto a = 0; a < n; ++a) {
+				for (auto b = a + 1; b < n; ++b) {
+					if (linked(a, b)) {
+						for (auto d = b + 1; d < n; ++d) {
+							triangles += linked(a, d) and linked(b, d) ? 1U : 0U;
+						}
+					}
+				}
+			}
+			CHECK(c.triangle_count() == triangles);
+
+			for (auto i = 0; i < 50; ++i) {
+				auto a = static_cast<int>(roll(static_cast<unsigned>(n)));
+				auto b = static_cast<int>(roll(3));
+				auto expected = std::vector<int>{};
+				auto ca = g.connections(a);
+				auto cb = g.connections(b);
+				std::set_intersection(ca.begin(), ca.end(), cb.begin(), cb.end(), std::back_inserter(expected));
+				CHECK(c.common_neighbours(a, b) == expected);
+			}
+		}
+	}
+	SECTION("the vectorised kernels agree with the scalar ones") {
+		namespace simd = gdwg::detail::simd;
+		auto sorted_run = [&](std::size_t size, unsigned range) {
+			auto run = std::vector<std::uint32_t>(size);
+			for (auto& v : run) {
+				v = roll(range);
+			}
+			std::sort(run.begin(), run.end());
+			return run;
+		};
+		for (auto round = 0U; round < 200; ++round) {
+			auto a = sorted_run(roll(100), 40 + round);
+			auto b = sorted_run(roll(4) == 0 ? roll(5000) : roll(100), 40 + round);
+			auto expected = std::vector<std::uint32_t>{};
+			simd::scalar::intersect(a, b, expected);
+			auto got = std::vector<std::uint32_t>{};
+			simd::intersect(a, b, got);
+			CHECK(got == expected);
+
+			a.erase(std::unique(a.begin(), a.end()), a.end());
+			b.erase(std::unique(b.begin(), b.end()), b.end());
+			CHECK(simd::intersect_count(a, b) == simd::scalar::intersect_count(a, b));
+			auto value = roll(40 + round);
+			CHECK(simd::lower_bound(b, value) == simd::scalar::lower_bound(b, value));
+		}
+	}
+}
@@ -0,0 +1,231 @@
+// Benchmarks of every graph operation, on uniform and power law graphs of int and std::string nodes.
+// The suites from 1K to 100K edges run by default, the larger ones are hidden and picked by tag:
+//
+//   gdwg_graph_bench                          1K, 10K and 100K edges
+//   gdwg_graph_bench "[1M]" "[10M]"           the large scales
+//   gdwg_graph_bench -r xml -o results.xml    machine readable results, for tracking over time
+//
+// The gdwg_graph_bench_results target runs the default suites with the XML reporter.
+
+// this file is its own Catch2 main, built with benchmarking enabled
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "gdwg_graph.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+	enum class shape { uniform, power_law };
+
+	template<typename N>
+	auto make_node(std::size_t i) -> N {
+		if constexpr (std::is_same_v<N, std::string>) {
+			// long enough to keep the strings off the small string buffer
+			return "benchmark node " + std::to_string(i);
+		}
+		else {
+			return static_cast<N>(i);
+		}
+	}
+
+	// a graph of the given shape with num_edges edges over num_edges / 8 nodes, the same data as the
+	// ranges it was bulk loaded from, and queries that are half edges of the graph, half random pairs
+	template<typename N>
+	struct workload {
+		using graph_type = gdwg::graph<N, int>;
+
+		std::vector<N> nodes;
+		std::vector<std::tuple<N, N, int>> edges;
+		std::vector<std::tuple<N, N, int>> queries;
+		graph_type g;
+
+		workload(shape s, std::size_t num_edges) {
+			auto const num_nodes = std::max(num_edges / 8, std::size_t{16});
+			auto rng = std::mt19937_64{6771};
+			auto uniform = std::uniform_int_distribution<std::size_t>{0, num_nodes - 1};
+			auto unit = std::uniform_real_distribution<double>{0.0, 1.0};
+			auto weight = std::uniform_int_distribution<int>{0, 99};
+			// cubing a uniform number piles the endpoints onto the first few nodes, so a handful of hubs
+			// hold most of the edges while most nodes have next to none
+			auto pick = [&] {
+				if (s == shape::uniform) {
+					return uniform(rng);
+				}
+				auto u = unit(rng);
+				return std::min(static_cast<std::size_t>(static_cast<double>(num_nodes) * u * u * u), num_nodes - 1);
+			};
+			for (auto i = std::size_t{0}; i != num_nodes; ++i) {
+				nodes.push_back(make_node<N>(i));
+			}
+			for (auto i = std::size_t{0}; i != num_edges; ++i) {
+				edges.emplace_back(nodes[pick()], nodes[pick()], weight(rng));
+			}
+			for (auto i = std::size_t{0}; i != 1024; ++i) {
+				if (i % 2 == 0) {
+					queries.push_back(edges[uniform(rng) % edges.size()]);
+				}
+				else {
+					queries.emplace_back(nodes[pick()], nodes[pick()], weight(rng));
+				}
+			}
+			g = graph_type(nodes.begin(), nodes.end(), edges.begin(), edges.end());
+		}
+
+		auto query(int i) const -> std::tuple<N, N, int> const& {
+			return queries[static_cast<std::size_t>(i) % queries.size()];
+		}
+
+		// a copy with storage of its own. Copies share storage until modified, so the first
+		// modification of a plain copy would pay for copying the whole graph
+		auto owned_copy() const -> graph_type {
+			auto copy = g;
+			(void)copy.insert_node(nodes.front());
+			return copy;
+		}
+
+		auto owned_copies(int runs) const -> std::vector<graph_type> {
+			auto copies = std::vector<graph_type>{};
+			for (auto i = 0; i != runs; ++i) {
+				copies.push_back(owned_copy());
+			}
+			return copies;
+		}
+	};
+
+	template<typename N>
+	void run_benchmarks(std::size_t num_edges) {
+		for (auto s : {shape::uniform, shape::power_law}) {
+			auto const w = workload<N>(s, num_edges);
+			using graph_type = typename workload<N>::graph_type;
+			auto const name = [s](char const* op) {
+				return std::string{s == shape::uniform ? "uniform " : "power law "} + op;
+			};
+
+			BENCHMARK_ADVANCED(name("insert_node"))(Catch::Benchmark::Chronometer meter) {
+				auto g = w.owned_copy();
+				auto const first = w.nodes.size() + 1;
+				meter.measure([&](int i) { return g.insert_node(make_node<N>(first + static_cast<std::size_t>(i))); });
+			};
+
+			BENCHMARK_ADVANCED(name("insert_edge"))(Catch::Benchmark::Chronometer meter) {
+				auto g = w.owned_copy();
+				// weights outside those of the workload, so every edge is new
+				meter.measure([&](int i) {
+					auto const& [src, dst, weight] = w.query(i);
+					return g.insert_edge(src, dst, 100 + i);
+				});
+			};
+
+			BENCHMARK(name("bulk load")) {
+				return graph_type(w.nodes.begin(), w.nodes.end(), w.edges.begin(), w.edges.end());
+			};
+
+			BENCHMARK_ADVANCED(name("find"))(Catch::Benchmark::Chronometer meter) {
+				meter.measure([&](int i) {
+					auto const& [src, dst, weight] = w.query(i);
+					return w.g.find(src, dst, weight);
+				});
+			};
+
+			BENCHMARK_ADVANCED(name("is_connected"))(Catch::Benchmark::Chronometer meter) {
+				meter.measure([&](int i) {
+					auto const& [src, dst, weight] = w.query(i);
+					return w.g.is_connected(src, dst);
+				});
+			};
+
+			BENCHMARK_ADVANCED(name("connections"))(Catch::Benchmark::Chronometer meter) {
+				meter.measure([&](int i) { return w.g.connections(std::get<0>(w.query(i))); });
+			};
+
+			BENCHMARK_ADVANCED(name("edges"))(Catch::Benchmark::Chronometer meter) {
+				meter.measure([&](int i) {
+					auto const& [src, dst, weight] = w.query(i);
+					return w.g.edges(src, dst);
+				});
+			};
+
+			BENCHMARK_ADVANCED(name("erase_node"))(Catch::Benchmark::Chronometer meter) {
+				auto copies = w.owned_copies(meter.runs());
+				meter.measure([&](int i) {
+					return copies[static_cast<std::size_t>(i)].erase_node(std::get<0>(w.query(i)));
+				});
+			};
+
+			BENCHMARK_ADVANCED(name("merge_replace_node"))(Catch::Benchmark::Chronometer meter) {
+				auto copies = w.owned_copies(meter.runs());
+				meter.measure([&](int i) {
+					auto const& [src, dst, weight] = w.query(i);
+					if (src != dst) {
+						copies[static_cast<std::size_t>(i)].merge_replace_node(src, dst);
+					}
+				});
+			};
+
+			BENCHMARK(name("copy")) {
+				return graph_type(w.g);
+			};
+
+			BENCHMARK(name("copy and modify")) {
+				return w.owned_copy();
+			};
+
+			BENCHMARK_ADVANCED(name("operator=="))(Catch::Benchmark::Chronometer meter) {
+				// a copy that shares storage would compare equal without looking at the edges
+				auto const other = w.owned_copy();
+				meter.measure([&] { return w.g == other; });
+			};
+
+			BENCHMARK(name("operator<<")) {
+				auto os = std::ostringstream{};
+				os << w.g;
+				return os.str().size();
+			};
+		}
+
+		// every edge into the same node, so keeping the reverse index is linear in the edges only if
+		// adding to it doesn't look through the edges already there
+		auto const num_nodes = std::max(num_edges / 8, std::size_t{16});
+		auto nodes = std::vector<N>{};
+		for (auto i = std::size_t{0}; i != num_nodes; ++i) {
+			nodes.push_back(make_node<N>(i));
+		}
+		auto into_one = std::vector<std::tuple<N, N, int>>{};
+		for (auto i = std::size_t{0}; i != num_edges; ++i) {
+			into_one.emplace_back(nodes[i % num_nodes], nodes.front(), static_cast<int>(i));
+		}
+		BENCHMARK("bulk insert into one node, reverse index") {
+			auto g = gdwg::bidirectional_graph<N, int>(nodes.begin(), nodes.end());
+			return g.insert_edges(into_one.begin(), into_one.end());
+		};
+	}
+} // namespace
+
+TEMPLATE_TEST_CASE("1K edges", "[1K]", int, std::string) {
+	run_benchmarks<TestType>(1'000);
+}
+
+TEMPLATE_TEST_CASE("10K edges", "[10K]", int, std::string) {
+	run_benchmarks<TestType>(10'000);
+}
+
+TEMPLATE_TEST_CASE("100K edges", "[100K]", int, std::string) {
+	run_benchmarks<TestType>(100'000);
+}
+
+TEMPLATE_TEST_CASE("1M edges", "[.][1M]", int, std::string) {
+	run_benchmarks<TestType>(1'000'000);
+}
+
+TEMPLATE_TEST_CASE("10M edges", "[.][10M]", int, std::string) {
+	run_benchmarks<TestType>(10'000'000);
+}
@@ -3,34 +3,87 @@
 
 #	include <iostream>
 #	include <set>
+#	include <span>
 #	include <sstream>
 #	include <string>
+#	include <string_view>
 #	include <optional>
+#	include <ranges>
 #	include <vector>
 #	include <algorithm>
+#	include <array>
+#	include <atomic>
+#	include <bit>
+#	include <chrono>
+#	include <compare>
+#	include <concepts>
+#	include <cstdint>
+#	include <execution>
 #	include <functional>
 #	include <iterator>
+#	include <map>
 #	include <memory>
+#	include <memory_resource>
+#	include <numeric>
 #	include <tuple>
+#	include <type_traits>
+#	include <unordered_map>
+#	include <unordered_set>
+#	include <utility>
+#	include <variant>
 
 // TODO: Make both graph and edge generic
 //       ... this won't just compile
 //       straight away
 namespace gdwg {
+	// the weight of an edge of a graph<N, void>, which has none and takes no space in the edge
+	struct no_weight {
+		[[nodiscard]] constexpr auto has_value() const noexcept -> bool {
+			return false;
+		}
+
+		friend constexpr auto operator<=>(no_weight, no_weight) noexcept = default;
+	};
+
+	// what an edge stores as its weight, an optional E, or nothing at all when E is void
+	template<typename E>
+	struct weight_of {
+		using type = std::optional<E>;
+	};
+
+	template<>
+	struct weight_of<void> {
+		using type = no_weight;
+	};
+
+	template<typename E>
+	using weight_t = typename weight_of<E>::type;
+
+	// writes an edge in the format print_edge() and graph's operator<< use, straight to os
+	template<typename N, typename Weight>
+	auto write_edge(std::ostream& os, N const& src, N const& dst, Weight const& weight) -> std::ostream& {
+		os << src << " -> " << dst;
+		if constexpr (not std::is_same_v<Weight, no_weight>) {
+			if (weight.has_value()) {
+				return os << " | W | " << weight.value();
+			}
+		}
+		return os << " | U";
+	}
+
 	template<typename N, typename E>
 	class edge {
 	 public:
 		virtual auto print_edge() const -> std::string = 0;
 		virtual auto is_weighted() const -> bool = 0;
-		virtual auto get_weight() const -> std::optional<E> = 0;
+		virtual auto get_weight() const -> weight_t<E> = 0;
 		virtual auto get_nodes() const -> std::pair<N, N> = 0;
 		virtual ~edge(){};
 
-	 private:
-		// helper function for replace_node and merge_replace
-		virtual void replace(int p, const N& v) noexcept = 0;
-		template<typename T, typename U>
-		friend class graph;
+	 protected:
+		edge() = default;
+		edge(edge const&) = default;
+		auto operator=(edge const&) -> edge& = default;
 	};
 
 	template<typename N, typename E>
@@ -44,16 +97,15 @@ namespace gdwg {
 
 		auto print_edge() const -> std::string override {
 			std::ostringstream oss;
-			oss << src_ << " -> " << dst_ << " | W | " << weight_;
-			std::string res = oss.str();
-			return res;
+			write_edge(oss, src_, dst_, weight_t<E>{weight_});
+			return oss.str();
 		}
 
 		auto is_weighted() const -> bool override {
 			return is_weighted_;
 		}
 
-		auto get_weight() const -> std::optional<E> override {
+		auto get_weight() const -> weight_t<E> override {
 			return weight_;
 		}
 
@@ -66,11 +118,6 @@ namespace gdwg {
 		N dst_;
 		bool is_weighted_;
 		E weight_;
-		void replace(int p, const N& v) noexcept override {
-			(p == 1 ? dst_ : src_) = v;
-		}
-		template<typename T, typename U>
-		friend class graph;
 	};
 
 	template<typename N, typename E>
@@ -83,17 +130,16 @@ namespace gdwg {
 
 		auto print_edge() const -> std::string override {
 			std::ostringstream oss;
-			oss << src_ << " -> " << dst_ << " | U";
-			std::string res = oss.str();
-			return res;
+			write_edge(oss, src_, dst_, weight_t<E>{});
+			return oss.str();
 		}
 
 		auto is_weighted() const -> bool override {
 			return is_weighted_;
 		}
 
-		auto get_weight() const -> std::optional<E> override {
-			return std::nullopt;
+		auto get_weight() const -> weight_t<E> override {
+			return {};
 		}
 
 		auto get_nodes() const -> std::pair<N, N> override {
@@ -104,398 +150,2302 @@ namespace gdwg {
 		N src_;
 		N dst_;
 		bool is_weighted_;
-		void replace(int p, const N& v) noexcept override {
-			(p == 1 ? dst_ : src_) = v;
-		}
-		template<typename T, typename U>
-		friend class graph;
 	};
 
+	// non-owning edge over the storage of a graph, only valid until that graph is modified
 	template<typename N, typename E>
-	class graph {
-		class iterator;
-
+	class edge_view : public edge<N, E> {
 	 public:
-		using edge = std::shared_ptr<gdwg::edge<N, E>>;
-		using edge_iterator = std::vector<edge>::const_iterator;
+		edge_view(N const& src, N const& dst, weight_t<E> const& weight)
+		: src_(&src)
+		, dst_(&dst)
+		, weight_(&weight) {}
 
-		// constructors
-		graph()
-		: nodes_{}
-		, edges_{} {}
+		auto print_edge() const -> std::string override {
+			std::ostringstream oss;
+			write_edge(oss, *src_, *dst_, *weight_);
+			return oss.str();
+		}
 
-		graph(std::initializer_list<N> il)
-		: nodes_{std::set<N>(il.begin(), il.end())}
-		, edges_{} {}
+		auto is_weighted() const -> bool override {
+			return weight_->has_value();
+		}
 
-		template<typename InputIt>
-		graph(InputIt first, InputIt last)
-		: nodes_{std::set<N>(first, last)}
-		, edges_{} {}
+		auto get_weight() const -> weight_t<E> override {
+			return *weight_;
+		}
 
-		// move
-		graph(graph&& other) noexcept
-		: nodes_{std::move(other.nodes_)}
-		, edges_{std::move(other.edges_)} {}
+		auto get_nodes() const -> std::pair<N, N> override {
+			return std::pair<N, N>{*src_, *dst_};
+		}
 
-		auto operator=(graph&& other) noexcept -> graph& {
-			nodes_ = std::move(other.nodes_);
-			edges_ = std::move(other.edges_);
-			return *this;
+		// the endpoints and weight as stored in the graph, nothing is copied
+		auto src() const noexcept -> N const& {
+			return *src_;
 		}
 
-		// copy
-		graph(graph const& other)
-		: nodes_{other.nodes_}
-		, edges_{other.edges_} {}
+		auto dst() const noexcept -> N const& {
+			return *dst_;
+		}
 
-		auto operator=(graph const& other) -> graph& {
-			nodes_ = other.nodes_;
-			edges_ = other.edges_;
-			return *this;
+		auto weight() const noexcept -> weight_t<E> const& {
+			return *weight_;
 		}
 
-		~graph() = default;
+	 private:
+		N const* src_;
+		N const* dst_;
+		weight_t<E> const* weight_;
+	};
 
-		// modifiers
-		auto insert_node(N const& value) noexcept -> bool {
-			if (nodes_.contains(value)) {
-				return false;
-			}
-			nodes_.insert(value);
-			return true;
+	// pointer-like handle to an edge stored in a graph, this is what graph::edge_iterator
+	// dereferences to so looking at an edge never allocates
+	template<typename N, typename E>
+	class edge_handle {
+	 public:
+		edge_handle(N const& src, N const& dst, weight_t<E> const& weight)
+		: view_(src, dst, weight) {}
+
+		auto operator->() const noexcept -> edge<N, E> const* {
+			return &view_;
 		}
 
-		auto insert_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
-			if (is_node(src) and is_node(dst)) {
-				if (find(src, dst, weight) == edges_.end()) {
-					if (weight == std::nullopt) {
-						edge new_edge = std::make_shared<unweighted_edge<N, E>>(src, dst);
-						edges_.push_back(new_edge);
-					}
-					else {
-						edge new_edge = std::make_shared<weighted_edge<N, E>>(src, dst, weight.value());
-						edges_.push_back(new_edge);
-					}
-					sortedges();
-					return true;
-				}
-				return false;
-			}
-			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not "
-			                        "exist"};
-			throw std::runtime_error{emsg};
+		auto operator*() const noexcept -> edge<N, E> const& {
+			return view_;
 		}
 
-		auto replace_node(N const& old_data, N const& new_data) -> bool {
-			if (is_node(old_data)) {
-				if (not is_node(new_data)) {
-					nodes_.erase(old_data);
-					nodes_.insert(new_data);
-					for (auto const& e : edges_) {
-						auto strpair = e->get_nodes();
-						if (strpair.first == old_data) {
-							e->replace(0, new_data);
-						}
-						if (strpair.second == old_data) {
-							e->replace(1, new_data);
-						}
-					}
-					sortedges();
-					return true;
+		auto src() const noexcept -> N const& {
+			return view_.src();
+		}
+
+		auto dst() const noexcept -> N const& {
+			return view_.dst();
+		}
+
+		auto weight() const noexcept -> weight_t<E> const& {
+			return view_.weight();
+		}
+
+		// detaches an owning copy of the edge
+		operator std::shared_ptr<edge<N, E>>() const {
+			auto [src, dst] = view_.get_nodes();
+			if constexpr (not std::is_void_v<E>) {
+				if (auto weight = view_.get_weight(); weight.has_value()) {
+					return std::make_shared<weighted_edge<N, E>>(src, dst, weight.value());
 				}
-				return false;
 			}
-			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::replace_node on a node that doesn't exist"};
-			throw std::runtime_error{emsg};
+			return std::make_shared<unweighted_edge<N, E>>(src, dst);
 		}
 
-		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
-			if (is_node(old_data) and is_node(new_data)) {
-				for (auto e = edges_.begin(); e != edges_.end();) {
-					auto strpair = (*e)->get_nodes();
-					if (strpair.first == old_data) {
-						(*e)->replace(0, new_data);
-					}
-					if (strpair.second == old_data) {
-						(*e)->replace(1, new_data);
-					}
-					strpair = (*e)->get_nodes();
-					auto first_it = find(strpair.first, strpair.second, (*e)->get_weight());
-					if (first_it != e) {
-						e = edges_.erase(e);
-					}
-					else {
-						++e;
-					}
-				}
-				sortedges();
+	 private:
+		edge_view<N, E> view_;
+	};
+
+	// Node index policies for graph, these decide how a value is looked up among the nodes owned by
+	// the graph. The nodes themselves always live in the ordered set, so output stays sorted either way.
+	// A policy that allocates declares an allocator_type and is built with the allocator of the graph.
+
+	// searches the node set itself, O(log V)
+	template<typename N>
+	class ordered_node_index {
+	 public:
+		[[nodiscard]] auto find(std::pmr::set<N> const& nodes, N const& value) const noexcept -> N const* {
+			auto it = nodes.find(value);
+			return it == nodes.end() ? nullptr : &*it;
+		}
+
+		void insert(N const*) noexcept {}
+		void erase(N const*) noexcept {}
+		void clear() noexcept {}
+	};
+
+	// keeps an open addressing (linear probing) hash table of handles to the nodes of the graph,
+	// so membership checks are O(1) expected
+	template<typename N, typename Hash = std::hash<N>, typename KeyEqual = std::equal_to<N>>
+	class hashed_node_index {
+	 public:
+		using allocator_type = std::pmr::polymorphic_allocator<>;
+
+		hashed_node_index() = default;
+		explicit hashed_node_index(allocator_type const& alloc)
+		: slots_(alloc) {}
+		// the handles belong to one graph, a copy of that graph builds its own index
+		hashed_node_index(hashed_node_index const&) = delete;
+		auto operator=(hashed_node_index const&) -> hashed_node_index& = delete;
+
+		hashed_node_index(hashed_node_index&& other) noexcept
+		: slots_{std::move(other.slots_)}
+		, size_{std::exchange(other.size_, 0)}
+		, shift_{std::exchange(other.shift_, 64)} {}
+
+		auto operator=(hashed_node_index&& other) noexcept -> hashed_node_index& {
+			slots_ = std::move(other.slots_);
+			size_ = std::exchange(other.size_, 0);
+			shift_ = std::exchange(other.shift_, 64);
+			return *this;
+		}
+
+		~hashed_node_index() = default;
+
+		[[nodiscard]] auto find(std::pmr::set<N> const&, N const& value) const noexcept -> N const* {
+			if (size_ == 0) {
+				return nullptr;
 			}
-			else {
-				auto emsg = std::string{"Cannot call gdwg::graph<N, E>::merge_replace_node on old or new data if they "
-				                        "don't exist in the graph"};
-				throw std::runtime_error{emsg};
+			auto hash = hash_of(value);
+			for (auto i = home(hash); slots_[i].node != nullptr; i = next(i)) {
+				if (slots_[i].hash == hash and KeyEqual{}(*slots_[i].node, value)) {
+					return slots_[i].node;
+				}
 			}
+			return nullptr;
 		}
 
-		auto erase_node(N const& value) noexcept -> bool {
-			if (is_node(value)) {
-				for (auto e = edges_.begin(); e != edges_.end();) {
-					auto strpair = (*e)->get_nodes();
-					if (strpair.first == value or strpair.second == value) {
-						e = edges_.erase(e);
-					}
-					else {
-						++e;
-					}
-				}
-				nodes_.erase(value);
-				sortedges();
-				return true;
+		void insert(N const* node) {
+			// keep the load factor at or below one half
+			if ((size_ + 1) * 2 > slots_.size()) {
+				grow();
 			}
-			return false;
+			place(slot{hash_of(*node), node});
+			++size_;
 		}
 
-		auto erase_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
-			if (is_node(src) and is_node(dst)) {
-				auto target_it = find(src, dst, weight);
-				if (target_it != edges_.end()) {
-					edges_.erase(target_it);
-					sortedges();
-					return true;
+		// node must be in the index and still hold the value it was inserted with
+		void erase(N const* node) noexcept {
+			auto i = home(hash_of(*node));
+			while (slots_[i].node != node) {
+				i = next(i);
+			}
+			// backward shift deletion, pull later entries of the probe run into the hole so
+			// lookups never need tombstones
+			for (auto j = next(i); slots_[j].node != nullptr; j = next(j)) {
+				if (((j - home(slots_[j].hash)) & mask()) >= ((j - i) & mask())) {
+					slots_[i] = slots_[j];
+					i = j;
 				}
-				return false;
 			}
-			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't exist in "
-			                        "the graph"};
-			throw std::runtime_error{emsg};
+			slots_[i] = slot{};
+			--size_;
 		}
 
-		auto erase_edge(edge_iterator i) noexcept -> edge_iterator {
-			auto res = edges_.erase(i);
-			sortedges();
-			return res;
+		// keeps the table, so refilling the graph to its old size doesn't grow it again
+		void clear() noexcept {
+			std::fill(slots_.begin(), slots_.end(), slot{});
+			size_ = 0;
 		}
 
-		auto erase_edge(edge_iterator i, edge_iterator s) noexcept -> edge_iterator {
-			auto res = edges_.erase(i, s);
-			sortedges();
-			return res;
-		}
+	 private:
+		struct slot {
+			std::uint64_t hash = 0;
+			N const* node = nullptr;
+		};
 
-		auto clear() noexcept -> void {
-			nodes_ = std::set<N>{};
-			edges_ = std::vector<edge>{};
+		std::pmr::vector<slot> slots_;
+		std::size_t size_ = 0;
+		// slots_.size() is always 2^(64 - shift_)
+		std::uint64_t shift_ = 64;
+
+		// fibonacci hashing spreads weak hashes (std::hash<int> is the identity) over the high bits
+		static auto hash_of(N const& value) noexcept -> std::uint64_t {
+			return static_cast<std::uint64_t>(Hash{}(value)) * 0x9E3779B97F4A7C15ull;
 		}
 
-		// accessors
-		[[nodiscard]] auto is_node(N const& value) const noexcept -> bool {
-			return nodes_.contains(value);
+		auto home(std::uint64_t hash) const noexcept -> std::size_t {
+			return static_cast<std::size_t>(hash >> shift_);
 		}
 
-		[[nodiscard]] auto empty() const noexcept -> bool {
-			return nodes_.empty();
+		auto mask() const noexcept -> std::size_t {
+			return slots_.size() - 1;
 		}
 
-		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
-			if (is_node(src) and is_node(dst)) {
-				for (auto const& e : edges_) {
-					auto strpair = e->get_nodes();
-					if (strpair.first == src and strpair.second == dst) {
-						return true;
-					}
-				}
-				return false;
-			}
-			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the "
-			                        "graph"};
-			throw std::runtime_error{emsg};
+		auto next(std::size_t i) const noexcept -> std::size_t {
+			return (i + 1) & mask();
 		}
 
-		[[nodiscard]] auto nodes() const noexcept -> std::vector<N> {
-			auto res = std::vector<N>(nodes_.begin(), nodes_.end());
-			std::sort(res.begin(), res.end());
-			return res;
+		void place(slot s) noexcept {
+			auto i = home(s.hash);
+			while (slots_[i].node != nullptr) {
+				i = next(i);
+			}
+			slots_[i] = s;
 		}
 
-		[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<edge> {
-			if (is_node(src) and is_node(dst)) {
-				auto res = std::vector<edge>{};
-				std::function<bool(edge const&, edge const&)> sort_weight = [](edge const& a, edge const& b) {
-					return a->get_weight() < b->get_weight();
-				};
-				for (auto const& e : edges_) {
-					auto strpair = e->get_nodes();
-					if (strpair.first == src and strpair.second == dst) {
-						res.push_back(e);
-					}
+		void grow() {
+			auto old = std::exchange(slots_,
+			                         std::pmr::vector<slot>(slots_.empty() ? 8 : slots_.size() * 2, slots_.get_allocator()));
+			shift_ = slots_.empty() ? 64 : 64 - static_cast<std::uint64_t>(std::countr_zero(slots_.size()));
+			for (auto const& s : old) {
+				if (s.node != nullptr) {
+					place(s);
 				}
-				std::sort(res.begin(), res.end(), sort_weight);
-				return res;
 			}
-			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::edges if src or dst node don't exist in the graph"};
-			throw std::runtime_error{emsg};
 		}
+	};
 
-		[[nodiscard]] auto find(N const& src, N const& dst, std::optional<E> weight = std::nullopt) const noexcept
-		    -> edge_iterator {
-			for (auto e = edges_.begin(); e != edges_.end(); ++e) {
-				auto strpair = (*e)->get_nodes();
-				if (strpair.first == src and strpair.second == dst and (*e)->get_weight() == weight) {
-					return e;
-				}
+	// Reverse edge index policy that keeps nothing, in_connections() and in_edges() scan every edge
+	template<typename N, typename E>
+	class no_in_edge_index {
+	 public:
+		static constexpr auto enabled = false;
+
+		void insert(N const*, N const*, weight_t<E> const&) noexcept {}
+		void push(N const*, N const*, weight_t<E> const&) noexcept {}
+		void erase(N const*, N const*, weight_t<E> const&) noexcept {}
+		void forget(N const*) noexcept {}
+		void clear() noexcept {}
+
+		template<typename Edges>
+		void assign(Edges const&) noexcept {}
+	};
+
+	// Reverse edge index policy, the (src, weight) of every edge into a node is kept with that node so
+	// incoming edges are found in O(in-degree). Entries are keyed by the address of the stored node,
+	// which replace_node leaves alone, and kept in no particular order, so adding an edge known to be
+	// new is O(1) and every other change is O(in-degree)
+	template<typename N, typename E>
+	class in_edge_index {
+	 public:
+		static constexpr auto enabled = true;
+		using allocator_type = std::pmr::polymorphic_allocator<>;
+
+		struct entry {
+			N const* src;
+			[[no_unique_address]] weight_t<E> weight;
+		};
+
+		in_edge_index() = default;
+		explicit in_edge_index(allocator_type const& alloc)
+		: in_(alloc) {}
+
+		void insert(N const* src, N const* dst, weight_t<E> const& weight) {
+			auto& in = in_[dst];
+			if (std::find_if(in.begin(), in.end(), matches(src, weight)) == in.end()) {
+				in.push_back(entry{src, weight});
 			}
-			return edges_.end();
 		}
 
-		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
-			if (is_node(src)) {
-				auto res = std::vector<N>{};
-				for (auto const& e : edges_) {
-					auto strpair = e->get_nodes();
-					auto dst = strpair.second;
-					if (strpair.first == src and std::find(res.begin(), res.end(), dst) == res.end()) {
-						res.push_back(dst);
-					}
+		// an edge that isn't in the index yet
+		void push(N const* src, N const* dst, weight_t<E> const& weight) {
+			in_[dst].push_back(entry{src, weight});
+		}
+
+		void erase(N const* src, N const* dst, weight_t<E> const& weight) noexcept {
+			if (auto it = in_.find(dst); it != in_.end()) {
+				auto& in = it->second;
+				if (auto e = std::find_if(in.begin(), in.end(), matches(src, weight)); e != in.end()) {
+					*e = std::move(in.back());
+					in.pop_back();
 				}
-				std::sort(res.begin(), res.end());
-				return res;
 			}
-			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::connections if src doesn't exist in the graph"};
-			throw std::runtime_error{emsg};
 		}
 
-		// Iterator Access
-		[[nodiscard]] auto begin() const -> iterator {
-			return iterator(edges_.begin());
+		// drops the edges into node, for when it is erased
+		void forget(N const* node) noexcept {
+			in_.erase(node);
 		}
 
-		[[nodiscard]] auto end() const -> iterator {
-			return iterator(edges_.end());
+		void clear() noexcept {
+			in_.clear();
 		}
 
-		// Comparisons
-		[[nodiscard]] auto operator==(graph const& other) const noexcept -> bool {
-			auto other_n = other.nodes_;
-			auto other_e = other.edges_;
-			if (other_n.size() == nodes_.size() and other_e.size() == edges_.size()) {
-				for (auto const& n : other_n) {
-					if (std::find(nodes_.begin(), nodes_.end(), n) == nodes_.end()) {
-						return false;
-					}
-				}
-				for (auto const& e : other_e) {
-					auto strpair = e->get_nodes();
-					if (find(strpair.first, strpair.second, e->get_weight()) == edges_.end()) {
-						return false;
-					}
-				}
-			}
-			else {
-				return false;
+		// rebuilds the index from edges that are known to be free of duplicates
+		template<typename Edges>
+		void assign(Edges const& edges) {
+			in_.clear();
+			for (auto const& e : edges) {
+				in_[e.dst].push_back(entry{e.src, e.weight});
 			}
-			return true;
 		}
 
-		// Extractor
-		friend auto operator<<(std::ostream& os, graph const& g) noexcept -> std::ostream& {
-			std::ostringstream oss;
-			auto nodes = g.nodes();
-			oss << "\n";
-			for (auto const& n : nodes) {
-				oss << n << " (\n";
-				auto conn = g.connections(n);
-				for (auto const& cn : conn) {
-					auto cn_edges = g.edges(n, cn);
-					for (auto const& e : cn_edges) {
-						auto temp_str = e->print_edge();
-						oss << "  " << temp_str << "\n";
-					}
-				}
-				oss << ")\n";
+		[[nodiscard]] auto of(N const* dst) const noexcept -> std::span<entry const> {
+			if (auto it = in_.find(dst); it != in_.end()) {
+				return it->second;
 			}
-			auto res = oss.str();
-			os << res;
-			return os;
+			return {};
 		}
 
 	 private:
-		std::set<N> nodes_;
-		std::vector<edge> edges_;
+		std::pmr::unordered_map<N const*, std::pmr::vector<entry>> in_;
 
-		// helper function for keep the order of edges stored in graph
-		void sortedges() noexcept {
-			std::function<bool(edge const&, edge const&)> sort_weight = [](edge const& a, edge const& b) {
-				auto node_a = a->get_nodes(), node_b = b->get_nodes();
-				if (node_a.first != node_b.first) {
-					return node_a.first < node_b.first;
-				}
-				if (node_a.second != node_b.second) {
-					return node_a.second < node_b.second;
-				}
-				return a->get_weight() < b->get_weight();
-			};
-			std::sort(edges_.begin(), edges_.end(), sort_weight);
+		static auto matches(N const* src, weight_t<E> const& weight) noexcept {
+			return [src, &weight](entry const& e) { return e.src == src and e.weight == weight; };
 		}
 	};
 
-	template<typename N, typename E>
-	class graph<N, E>::iterator {
+	// the public operations of a graph that an instrumentation policy hears about. Lookups that are
+	// O(1) or lazy, is_node, empty, find_node, the views and iterators, aren't instrumented
+	enum class graph_op : std::uint8_t {
+		insert_node,
+		insert_edge,
+		insert_edges,
+		replace_node,
+		merge_replace_node,
+		erase_node,
+		erase_edge,
+		clear,
+		apply,
+		commit,
+		is_connected,
+		nodes,
+		edges,
+		find,
+		connections,
+		in_connections,
+		in_edges,
+		out_degree,
+		in_degree,
+		compare,
+		fingerprint,
+		print,
+	};
+	inline constexpr auto graph_op_count = std::size_t{22};
+
+	[[nodiscard]] constexpr auto to_string(graph_op op) noexcept -> std::string_view {
+		constexpr auto names = std::array<std::string_view, graph_op_count>{
+		    "insert_node", "insert_edge", "insert_edges", "replace_node",   "merge_replace_node", "erase_node",
+		    "erase_edge",  "clear",       "apply",        "commit",         "is_connected",       "nodes",
+		    "edges",       "find",        "connections",  "in_connections", "in_edges",           "out_degree",
+		    "in_degree",   "compare",     "fingerprint",  "print"};
+		return names[static_cast<std::size_t>(op)];
+	}
+
+	// what one call of a public operation cost. Only the outermost call is measured, the work of the
+	// operations it makes on the way is charged to it. edges_scanned counts the edges visited by
+	// linear passes, compared or moved, and allocations those of the node set, the edge array and of
+	// copy on write copies, not of scratch space
+	struct op_sample {
+		graph_op op;
+		std::chrono::nanoseconds latency;
+		std::size_t edges_scanned;
+		std::size_t sorts;
+		std::size_t allocations;
+	};
+
+	// the totals of one operation. latency[k] counts the calls that took [2^(k - 1), 2^k) ns, the
+	// last bucket those that took longer
+	struct op_stats {
+		static constexpr auto latency_buckets = std::size_t{40};
+
+		std::uint64_t calls;
+		std::uint64_t edges_scanned;
+		std::uint64_t sorts;
+		std::uint64_t allocations;
+		std::array<std::uint64_t, latency_buckets> latency;
+	};
+
+	struct graph_stats {
+		std::array<op_stats, graph_op_count> ops;
+
+		[[nodiscard]] auto operator[](graph_op op) const noexcept -> op_stats const& {
+			return ops[static_cast<std::size_t>(op)];
+		}
+	};
+
+	// Instrumentation policy that records nothing and takes no space, the default
+	struct no_instrumentation {
+		static constexpr auto enabled = false;
+	};
+
+	// Instrumentation policy that keeps op_stats for every operation, see graph::stats(), and hands
+	// every op_sample to a callback for export. The counters are relaxed atomics, so readers of one
+	// graph on several threads may record at once. A copy starts from the totals of the original,
+	// a move takes them and the callback, so the stats of a graph follow its contents
+	class counting_instrumentation {
 	 public:
-		using value_type = struct {
-			N from;
-			N to;
-			std::optional<E> weight;
-		};
-		using reference = value_type;
-		using pointer = void;
-		using difference_type = std::ptrdiff_t;
-		using iterator_category = std::bidirectional_iterator_tag;
+		static constexpr auto enabled = true;
+		using callback = std::function<void(op_sample const&)>;
 
-		// Iterator constructor
-		iterator() = default;
+		counting_instrumentation() = default;
 
-		// Iterator source
-		auto operator*() const noexcept -> reference {
-			auto strpair = (*curr_)->get_nodes();
-			auto weight = (*curr_)->get_weight();
-			return value_type{strpair.first, strpair.second, weight};
+		counting_instrumentation(counting_instrumentation const& other)
+		: callback_{other.callback_} {
+			assign(other.stats());
 		}
 
-		// Iterator traversal
-		auto operator++() noexcept -> iterator& {
-			++curr_;
+		// the callback and totals are taken over, other starts again from zero without a callback
+		counting_instrumentation(counting_instrumentation&& other) noexcept {
+			take(other);
+		}
+
+		auto operator=(counting_instrumentation const&) -> counting_instrumentation& = delete;
+
+		auto operator=(counting_instrumentation&& other) noexcept -> counting_instrumentation& {
+			if (this != &other) {
+				take(other);
+			}
 			return *this;
 		}
 
-		auto operator++(int) noexcept -> iterator {
-			auto copy{*this};
-			++(*this);
-			return copy;
+		~counting_instrumentation() = default;
+
+		// f is called on the thread that made the operation, once it returns. f must not throw, and
+		// must be set before the graph is shared between threads
+		void on_operation(callback f) {
+			callback_ = std::move(f);
 		}
 
-		auto operator--() noexcept -> iterator& {
-			--curr_;
-			return *this;
+		[[nodiscard]] auto stats() const noexcept -> graph_stats {
+			auto res = graph_stats{};
+			for (auto op = std::size_t{0}; op != graph_op_count; ++op) {
+				auto const& from = ops_[op];
+				auto& to = res.ops[op];
+				to.calls = from.calls.load(std::memory_order_relaxed);
+				to.edges_scanned = from.edges_scanned.load(std::memory_order_relaxed);
+				to.sorts = from.sorts.load(std::memory_order_relaxed);
+				to.allocations = from.allocations.load(std::memory_order_relaxed);
+				for (auto k = std::size_t{0}; k != op_stats::latency_buckets; ++k) {
+					to.latency[k] = from.latency[k].load(std::memory_order_relaxed);
+				}
+			}
+			return res;
 		}
 
-		auto operator--(int) noexcept -> iterator {
-			auto copy{*this};
-			--(*this);
-			return copy;
+		void reset() noexcept {
+			for (auto& c : ops_) {
+				c.calls.store(0, std::memory_order_relaxed);
+				c.edges_scanned.store(0, std::memory_order_relaxed);
+				c.sorts.store(0, std::memory_order_relaxed);
+				c.allocations.store(0, std::memory_order_relaxed);
+				for (auto& bucket : c.latency) {
+					bucket.store(0, std::memory_order_relaxed);
+				}
+			}
 		}
 
-		// Iterator comparison
-		auto operator==(iterator const& other) const noexcept -> bool {
-			return curr_ == other.curr_;
+		void record(op_sample const& sample) {
+			auto& c = ops_[static_cast<std::size_t>(sample.op)];
+			c.calls.fetch_add(1, std::memory_order_relaxed);
+			c.edges_scanned.fetch_add(sample.edges_scanned, std::memory_order_relaxed);
+			c.sorts.fetch_add(sample.sorts, std::memory_order_relaxed);
+			c.allocations.fetch_add(sample.allocations, std::memory_order_relaxed);
+			auto ns = static_cast<std::uint64_t>(std::max(sample.latency.count(), std::int64_t{0}));
+			auto bucket = std::min(static_cast<std::size_t>(std::bit_width(ns)), op_stats::latency_buckets - 1);
+			c.latency[bucket].fetch_add(1, std::memory_order_relaxed);
+			if (callback_) {
+				callback_(sample);
+			}
 		}
 
 	 private:
-		explicit iterator(edge_iterator curr)
-		: curr_(curr) {}
-		edge_iterator curr_{};
-		friend class graph<N, E>;
+		struct counters {
+			std::atomic<std::uint64_t> calls;
+			std::atomic<std::uint64_t> edges_scanned;
+			std::atomic<std::uint64_t> sorts;
+			std::atomic<std::uint64_t> allocations;
+			std::array<std::atomic<std::uint64_t>, op_stats::latency_buckets> latency;
+		};
+		std::array<counters, graph_op_count> ops_{};
+		callback callback_;
+
+		void assign(graph_stats const& totals) noexcept {
+			for (auto op = std::size_t{0}; op != graph_op_count; ++op) {
+				assign(ops_[op], totals.ops[op]);
+			}
+		}
+
+		void take(counting_instrumentation& other) noexcept {
+			callback_ = nullptr;
+			callback_.swap(other.callback_);
+			assign(other.stats());
+			other.reset();
+		}
+
+		static void assign(counters& to, op_stats const& from) noexcept {
+			to.calls.store(from.calls, std::memory_order_relaxed);
+			to.edges_scanned.store(from.edges_scanned, std::memory_order_relaxed);
+			to.sorts.store(from.sorts, std::memory_order_relaxed);
+			to.allocations.store(from.allocations, std::memory_order_relaxed);
+			for (auto k = std::size_t{0}; k != op_stats::latency_buckets; ++k) {
+				to.latency[k].store(from.latency[k], std::memory_order_relaxed);
+			}
+		}
 	};
+
+	// tag for constructors given nodes that are already sorted and free of duplicates
+	struct sorted_unique_t {
+		explicit sorted_unique_t() = default;
+	};
+	inline constexpr auto sorted_unique = sorted_unique_t{};
+
+	// The changes that turn one graph into another, see gdwg::diff and graph::apply. Every list is
+	// sorted, and the edges into or out of a removed node are left to the removal of that node
+	template<typename N, typename E>
+	struct graph_delta {
+		using edge_type = std::tuple<N, N, weight_t<E>>;
+
+		std::vector<N> added_nodes;
+		std::vector<N> removed_nodes;
+		std::vector<edge_type> added_edges;
+		std::vector<edge_type> removed_edges;
+
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return added_nodes.empty() and removed_nodes.empty() and added_edges.empty() and removed_edges.empty();
+		}
+
+		friend auto operator==(graph_delta const&, graph_delta const&) -> bool = default;
+	};
+
+	template<typename N,
+	         typename E,
+	         typename NodeIndex = ordered_node_index<N>,
+	         typename InIndex = no_in_edge_index<N, E>,
+	         typename Instrument = no_instrumentation>
+	class graph {
+		class iterator;
+		struct stored_edge;
+		using store_iterator = typename std::pmr::vector<stored_edge>::const_iterator;
+
+	 public:
+		using edge = std::shared_ptr<gdwg::edge<N, E>>;
+		// nodes, edges and the index policies all allocate from this, the scratch space of a
+		// modification comes from the heap. A pmr N or E gets the allocator of the graph as well
+		using allocator_type = std::pmr::polymorphic_allocator<>;
+		class edge_iterator;
+		class connection_iterator;
+		class transaction;
+
+		// constructors
+		graph()
+		: graph(allocator_type{}) {}
+
+		explicit graph(allocator_type const& alloc)
+		: alloc_{alloc}
+		, data_{empty_storage()} {}
+
+		graph(std::initializer_list<N> il, allocator_type const& alloc = {})
+		: graph(alloc) {
+			own().nodes.insert(il.begin(), il.end());
+			index_nodes();
+		}
+
+		template<typename InputIt>
+		graph(InputIt first, InputIt last, allocator_type const& alloc = {})
+		: graph(alloc) {
+			own().nodes.insert(first, last);
+			index_nodes();
+		}
+
+		// builds the graph from a range of nodes and a range of (src, dst, weight) edges in one pass
+		template<typename NodeIt, typename EdgeIt>
+		graph(NodeIt node_first, NodeIt node_last, EdgeIt edge_first, EdgeIt edge_last, allocator_type const& alloc = {})
+		: graph(node_first, node_last, alloc) {
+			insert_edges(edge_first, edge_last);
+		}
+
+		// each node is appended at the end of the set, so this takes linear time
+		template<typename InputIt>
+		graph(sorted_unique_t, InputIt first, InputIt last, allocator_type const& alloc = {})
+		: graph(alloc) {
+			auto& nodes = own().nodes;
+			for (; first != last; ++first) {
+				nodes.emplace_hint(nodes.end(), *first);
+			}
+			index_nodes();
+		}
+
+		// the nodes are sorted and deduplicated under policy before the set is built from them
+		template<typename ExecutionPolicy, typename ForwardIt>
+		requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+		graph(ExecutionPolicy&& policy, ForwardIt first, ForwardIt last, allocator_type const& alloc = {})
+		: graph(sorted_nodes(policy, first, last), alloc) {}
+
+		// as above, then the edges are resolved, sorted and deduplicated under policy
+		template<typename ExecutionPolicy, typename NodeIt, typename EdgeIt>
+		requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+		graph(ExecutionPolicy&& policy,
+		      NodeIt node_first,
+		      NodeIt node_last,
+		      EdgeIt edge_first,
+		      EdgeIt edge_last,
+		      allocator_type const& alloc = {})
+		: graph(sorted_nodes(policy, node_first, node_last), alloc) {
+			insert_edges(policy, edge_first, edge_last);
+		}
+
+		// move, the memory resource moves with the graph
+		graph(graph&& other) noexcept
+		: alloc_{other.alloc_}
+		, data_{std::exchange(other.data_, empty_storage())}
+		, fingerprint_{other.fingerprint_.exchange(0, std::memory_order_relaxed)}
+		, instrument_{std::move(other.instrument_)} {}
+
+		graph(graph&& other, allocator_type const& alloc)
+		: graph(alloc) {
+			*this = std::move(other);
+		}
+
+		// the graph keeps its memory resource, when other allocates from a different one its nodes
+		// can't be taken over without moving them, so other is copied instead
+		auto operator=(graph&& other) -> graph& {
+			if (alloc_ != other.alloc_) {
+				return *this = graph(other, alloc_);
+			}
+			data_ = std::exchange(other.data_, empty_storage());
+			fingerprint_.store(other.fingerprint_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+			instrument_ = std::move(other.instrument_);
+			return *this;
+		}
+
+		// copy, the copy shares the nodes and edges of other until one of the two is modified. Like
+		// the standard containers, a copy allocates from the default resource unless it is given
+		// another, and a copy to a different resource than other's is made straight away
+		graph(graph const& other)
+		: graph(other, allocator_type{}) {}
+
+		graph(graph const& other, allocator_type const& alloc)
+		: alloc_{alloc}
+		, data_{other.data_->nodes.get_allocator() == alloc ? other.data_
+		                                                    : std::allocate_shared<storage>(alloc, *other.data_, alloc)}
+		, fingerprint_{other.fingerprint_.load(std::memory_order_relaxed)}
+		, instrument_{other.instrument_} {}
+
+		auto operator=(graph const& other) -> graph& {
+			if (this != &other) {
+				*this = graph(other, alloc_);
+			}
+			return *this;
+		}
+
+		~graph() = default;
+
+		// modifiers
+		// not noexcept, a new node may copy storage shared with another graph and rehash the node index
+		auto insert_node(N const& value) -> bool {
+			return add_node(value);
+		}
+
+		// value is only moved from when it is inserted
+		auto insert_node(N&& value) -> bool {
+			return add_node(std::move(value));
+		}
+
+		// the node is built from args before it can be looked up, so it is thrown away if it is already there
+		template<typename... Args>
+		requires std::constructible_from<N, Args...>
+		auto emplace_node(Args&&... args) -> bool {
+			auto const measure = probe{*this, graph_op::insert_node};
+			if (data_.use_count() > 1) {
+				// built here to be looked up first, as a shared graph is only copied for a node it doesn't have
+				auto value = std::optional<N>(std::in_place, std::forward<Args>(args)...);
+				return add_node(std::move(*value));
+			}
+			auto [node, inserted] = own().nodes.emplace(std::forward<Args>(args)...);
+			if (inserted) {
+				data_->index.insert(&*node);
+				modified();
+			}
+			return inserted;
+		}
+
+		auto insert_edge(N const& src, N const& dst, weight_t<E> weight = {}) -> bool {
+			auto const measure = probe{*this, graph_op::insert_edge};
+			auto src_node = find_node(src);
+			auto dst_node = find_node(dst);
+			if (src_node != nullptr and dst_node != nullptr) {
+				auto range = edge_range(src, dst);
+				auto pos = std::lower_bound(range.first, range.second, weight, weight_less{});
+				if (pos == range.second or pos->weight != weight) {
+					if (own_found()) {
+						src_node = find_node(src);
+						dst_node = find_node(dst);
+						range = edge_range(src, dst);
+						pos = std::lower_bound(range.first, range.second, weight, weight_less{});
+					}
+					probe::scanned(static_cast<std::size_t>(data_->edges.end() - pos));
+					// the edge goes in first, so the index never holds an edge the graph doesn't
+					auto e = data_->edges.insert(pos, stored_edge{src_node, dst_node, std::move(weight)});
+					try {
+						data_->in.push(src_node, dst_node, e->weight);
+					} catch (...) {
+						data_->edges.erase(e);
+						throw;
+					}
+					modified();
+					return true;
+				}
+				return false;
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not "
+			                        "exist"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the edge from src to dst weighted by E(args...)
+		template<typename... Args>
+		requires std::constructible_from<E, Args...>
+		auto emplace_edge(N const& src, N const& dst, Args&&... args) -> bool {
+			return insert_edge(src, dst, weight_t<E>(std::in_place, std::forward<Args>(args)...));
+		}
+
+		// inserts every (src, dst, weight) in the range, or (src, dst) when E is void, with a single sort and dedup pass,
+		// returns the number of edges that were not already in the graph
+		template<typename InputIt>
+		auto insert_edges(InputIt first, InputIt last) -> std::size_t {
+			auto const measure = probe{*this, graph_op::insert_edges};
+			auto new_edges = std::vector<stored_edge>{};
+			if constexpr (resolvable_in_order<InputIt>) {
+				auto count = static_cast<std::size_t>(last - first);
+				if (count >= radix_threshold and count * 64 >= data_->nodes.size()) {
+					new_edges = resolve_in_order(first, last);
+					first = last;
+				}
+			}
+			for (; first != last; ++first) {
+				new_edges.push_back(to_stored_edge(*first));
+			}
+			if (std::any_of(new_edges.begin(), new_edges.end(), [](stored_edge const& e) {
+				    return e.src == nullptr or e.dst == nullptr;
+			    }))
+			{
+				auto emsg = std::string{"Cannot call gdwg::graph<N, E>::insert_edges when either src or dst node "
+				                        "does not exist"};
+				throw std::runtime_error{emsg};
+			}
+			rehome(std::execution::seq, new_edges);
+			return merge_edges(std::move(new_edges));
+		}
+
+		// as above, with the lookups, sort and merge run under policy
+		template<typename ExecutionPolicy, typename ForwardIt>
+		requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+		auto insert_edges(ExecutionPolicy&& policy, ForwardIt first, ForwardIt last) -> std::size_t {
+			auto const measure = probe{*this, graph_op::insert_edges};
+			auto new_edges = std::vector<stored_edge>(static_cast<std::size_t>(std::distance(first, last)));
+			std::transform(policy, first, last, new_edges.begin(), [this](auto const& e) {
+				return to_stored_edge(e);
+			});
+			// a throw inside a parallel algorithm terminates, so missing nodes are only reported here
+			if (std::any_of(policy, new_edges.begin(), new_edges.end(), [](stored_edge const& e) {
+				    return e.src == nullptr or e.dst == nullptr;
+			    }))
+			{
+				auto emsg = std::string{"Cannot call gdwg::graph<N, E>::insert_edges when either src or dst node "
+				                        "does not exist"};
+				throw std::runtime_error{emsg};
+			}
+			rehome(policy, new_edges);
+			return merge_edges(policy, std::move(new_edges));
+		}
+
+		auto replace_node(N const& old_data, N const& new_data) -> bool {
+			return relabel_node(old_data, new_data);
+		}
+
+		// new_data is only moved from when the node is replaced
+		auto replace_node(N const& old_data, N&& new_data) -> bool {
+			return relabel_node(old_data, std::move(new_data));
+		}
+
+		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
+			auto const measure = probe{*this, graph_op::merge_replace_node};
+			auto old_node = find_node(old_data);
+			auto new_node = find_node(new_data);
+			if (old_node != nullptr and new_node != nullptr) {
+				if (own_found()) {
+					old_node = find_node(old_data);
+					new_node = find_node(new_data);
+				}
+				modified();
+				relabel([old_node, new_node](N const* n) { return n == old_node ? new_node : nullptr; });
+				// duplicates are adjacent once sorted, keep the first of each run
+				data_->edges.erase(std::unique(data_->edges.begin(), data_->edges.end()), data_->edges.end());
+			}
+			else {
+				auto emsg = std::string{"Cannot call gdwg::graph<N, E>::merge_replace_node on old or new data if they "
+				                        "don't exist in the graph"};
+				throw std::runtime_error{emsg};
+			}
+		}
+
+		auto erase_node(N const& value) -> bool {
+			auto const measure = probe{*this, graph_op::erase_node};
+			auto node = find_node(value);
+			if (node != nullptr) {
+				if (own_found()) {
+					node = find_node(value);
+				}
+				modified();
+				if constexpr (InIndex::enabled) {
+					for (auto e = edge_range(value); e.first != e.second; ++e.first) {
+						data_->in.erase(e.first->src, e.first->dst, e.first->weight);
+					}
+					// only the incident edges are looked at, the rest is moved down past them in one pass
+					auto doomed = incident_blocks(node);
+					// an empty block of node's own edges can start where the next block does, so ties on first
+					// are broken by last, keeping every gap between blocks a forward range
+					std::sort(doomed.begin(), doomed.end(), [](auto const& a, auto const& b) {
+						return std::tie(a.first, a.last) < std::tie(b.first, b.last);
+					});
+					auto at = [this](std::size_t i) { return data_->edges.begin() + static_cast<std::ptrdiff_t>(i); };
+					auto out = at(doomed.front().first);
+					probe::scanned(data_->edges.size() - doomed.front().first);
+					for (auto d = doomed.begin(); d != doomed.end(); ++d) {
+						auto gap_last = std::next(d) == doomed.end() ? data_->edges.size() : std::next(d)->first;
+						out = std::move(at(d->last), at(gap_last), out);
+					}
+					data_->edges.erase(out, data_->edges.end());
+				}
+				else {
+					// one compaction pass instead of shifting the tail once per erased edge
+					probe::scanned(data_->edges.size());
+					std::erase_if(data_->edges, [node](stored_edge const& e) { return e.src == node or e.dst == node; });
+				}
+				data_->in.forget(node);
+				data_->index.erase(node);
+				data_->nodes.erase(value);
+				return true;
+			}
+			return false;
+		}
+
+		auto erase_edge(N const& src, N const& dst, weight_t<E> weight = {}) -> bool {
+			auto const measure = probe{*this, graph_op::erase_edge};
+			if (is_node(src) and is_node(dst)) {
+				auto target_it = find(src, dst, weight);
+				if (target_it != edge_iterator(data_->edges.end())) {
+					erase_edge(target_it);
+					return true;
+				}
+				return false;
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't exist in "
+			                        "the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// i may point into storage this graph shares, so it is carried over by position
+		auto erase_edge(edge_iterator i) -> edge_iterator {
+			auto const measure = probe{*this, graph_op::erase_edge};
+			auto pos = i.curr_ - data_->edges.cbegin();
+			auto& edges = own().edges;
+			auto e = edges.cbegin() + pos;
+			modified();
+			data_->in.erase(e->src, e->dst, e->weight);
+			probe::scanned(static_cast<std::size_t>(edges.cend() - e));
+			return edge_iterator(edges.erase(e));
+		}
+
+		auto erase_edge(edge_iterator i, edge_iterator s) -> edge_iterator {
+			auto const measure = probe{*this, graph_op::erase_edge};
+			auto first = i.curr_ - data_->edges.cbegin();
+			auto last = s.curr_ - data_->edges.cbegin();
+			auto& edges = own().edges;
+			modified();
+			for (auto e = edges.cbegin() + first; e != edges.cbegin() + last; ++e) {
+				data_->in.erase(e->src, e->dst, e->weight);
+			}
+			probe::scanned(edges.size() - static_cast<std::size_t>(first));
+			return edge_iterator(edges.erase(edges.cbegin() + first, edges.cbegin() + last));
+		}
+
+		// starts buffering modifications to apply together, see graph::transaction
+		[[nodiscard]] auto batch() noexcept -> transaction {
+			return transaction(*this);
+		}
+
+		// makes the changes in delta as one transaction: the removed edges are erased in one pass, then
+		// the removed nodes, then the added nodes and edges are inserted with a single merge. Like a
+		// transaction, nothing changes if an edge refers to a node that wouldn't exist
+		auto apply(graph_delta<N, E> const& delta) -> void {
+			auto const measure = probe{*this, graph_op::apply};
+			auto t = batch();
+			for (auto const& [src, dst, weight] : delta.removed_edges) {
+				t.erase_edge(src, dst, weight);
+			}
+			for (auto const& value : delta.removed_nodes) {
+				t.erase_node(value);
+			}
+			for (auto const& value : delta.added_nodes) {
+				t.insert_node(value);
+			}
+			for (auto const& [src, dst, weight] : delta.added_edges) {
+				t.insert_edge(src, dst, weight);
+			}
+			t.commit();
+		}
+
+		// the edge storage and the node index keep their capacity for the nodes and edges that follow,
+		// unless they are shared with a copy, which keeps them instead
+		auto clear() noexcept -> void {
+			auto const measure = probe{*this, graph_op::clear};
+			if (data_.use_count() > 1) {
+				data_ = empty_storage();
+			}
+			else {
+				data_->nodes.clear();
+				data_->edges.clear();
+				data_->index.clear();
+				data_->in.clear();
+			}
+			modified();
+		}
+
+		// accessors
+		[[nodiscard]] auto get_allocator() const noexcept -> allocator_type {
+			return alloc_;
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const noexcept -> bool {
+			return find_node(value) != nullptr;
+		}
+
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return data_->nodes.empty();
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto const measure = probe{*this, graph_op::is_connected};
+			if (is_node(src) and is_node(dst)) {
+				auto range = edge_range(src, dst);
+				return range.first != range.second;
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the "
+			                        "graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		[[nodiscard]] auto nodes() const noexcept -> std::vector<N> {
+			auto const measure = probe{*this, graph_op::nodes};
+			// nodes is already ordered
+			return std::vector<N>(data_->nodes.begin(), data_->nodes.end());
+		}
+
+		[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<edge> {
+			auto const measure = probe{*this, graph_op::edges};
+			if (is_node(src) and is_node(dst)) {
+				// edges between src and dst are already ordered by weight
+				auto view = edges_view(src, dst);
+				return std::vector<edge>(view.begin(), view.end());
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::edges if src or dst node don't exist in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		[[nodiscard]] auto find(N const& src, N const& dst, weight_t<E> weight = {}) const noexcept
+		    -> edge_iterator {
+			auto const measure = probe{*this, graph_op::find};
+			auto range = edge_range(src, dst);
+			auto e = std::lower_bound(range.first, range.second, weight, weight_less{});
+			if (e != range.second and e->weight == weight) {
+				return edge_iterator(e);
+			}
+			return edge_iterator(data_->edges.end());
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto const measure = probe{*this, graph_op::connections};
+			if (is_node(src)) {
+				auto range = edge_range(src);
+				return std::vector<N>(connection_iterator(range.first, range.second),
+				                      connection_iterator(range.second, range.second));
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::connections if src doesn't exist in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the nodes with an edge into dst, ascending
+		[[nodiscard]] auto in_connections(N const& dst) const -> std::vector<N> {
+			auto const measure = probe{*this, graph_op::in_connections};
+			if (auto node = find_node(dst); node != nullptr) {
+				auto res = std::vector<N>{};
+				for (auto const& e : in_edge_list(node)) {
+					if (res.empty() or res.back() != *e.src) {
+						res.push_back(*e.src);
+					}
+				}
+				return res;
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::in_connections if dst doesn't exist in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the edges into dst, ordered by src then weight
+		[[nodiscard]] auto in_edges(N const& dst) const -> std::vector<edge> {
+			auto const measure = probe{*this, graph_op::in_edges};
+			if (auto node = find_node(dst); node != nullptr) {
+				auto res = std::vector<edge>{};
+				for (auto const& e : in_edge_list(node)) {
+					res.push_back(edge_handle<N, E>{*e.src, *e.dst, e.weight});
+				}
+				return res;
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::in_edges if dst doesn't exist in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the number of edges out of src, each weight counted, found by binary search in O(log E)
+		[[nodiscard]] auto out_degree(N const& src) const -> std::size_t {
+			auto const measure = probe{*this, graph_op::out_degree};
+			if (is_node(src)) {
+				auto range = edge_range(src);
+				return static_cast<std::size_t>(range.second - range.first);
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::out_degree if src doesn't exist in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the number of edges into dst, each weight counted. O(1) expected with the reverse edge
+		// index, otherwise every edge is looked at
+		[[nodiscard]] auto in_degree(N const& dst) const -> std::size_t {
+			auto const measure = probe{*this, graph_op::in_degree};
+			if (auto node = find_node(dst); node != nullptr) {
+				if constexpr (InIndex::enabled) {
+					return data_->in.of(node).size();
+				}
+				else {
+					auto const& edges = data_->edges;
+					probe::scanned(edges.size());
+					return static_cast<std::size_t>(
+					    std::count_if(edges.begin(), edges.end(), [node](stored_edge const& e) { return e.dst == node; }));
+				}
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::in_degree if dst doesn't exist in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the node stored in the graph equal to value, or nullptr. Its address doesn't change until the
+		// node is erased, so it can stand in for the node as a key. The one exception is the first
+		// modification of a graph that shares its storage with a copy, which moves every node
+		[[nodiscard]] auto find_node(N const& value) const noexcept -> N const* {
+			return data_->index.find(data_->nodes, value);
+		}
+
+		// Views, these iterate the storage of the graph lazily and are only valid until it is modified
+		[[nodiscard]] auto nodes_view() const noexcept {
+			return std::ranges::subrange(data_->nodes.begin(), data_->nodes.end());
+		}
+
+		[[nodiscard]] auto edges_view(N const& src, N const& dst) const -> std::ranges::subrange<edge_iterator> {
+			if (is_node(src) and is_node(dst)) {
+				auto range = edge_range(src, dst);
+				return {edge_iterator(range.first), edge_iterator(range.second)};
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::edges_view if src or dst node don't exist in the "
+			                        "graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// every edge out of src, ordered by dst then weight
+		[[nodiscard]] auto edges_view(N const& src) const -> std::ranges::subrange<edge_iterator> {
+			if (is_node(src)) {
+				auto range = edge_range(src);
+				return {edge_iterator(range.first), edge_iterator(range.second)};
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::edges_view if src doesn't exist in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		[[nodiscard]] auto connections_view(N const& src) const -> std::ranges::subrange<connection_iterator> {
+			if (is_node(src)) {
+				auto range = edge_range(src);
+				return {connection_iterator(range.first, range.second), connection_iterator(range.second, range.second)};
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::connections_view if src doesn't exist in the "
+			                        "graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// Iterator Access
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator(data_->edges.begin());
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator(data_->edges.end());
+		}
+
+		// Comparisons, both graphs keep their nodes and edges in the same order so they are walked once in
+		// lockstep. Copies that still share their storage are equal without the walk, and graphs whose
+		// fingerprints are both known and differ are told apart without it
+		[[nodiscard]] auto operator==(graph const& other) const noexcept -> bool {
+			auto const measure = probe{*this, graph_op::compare};
+			auto const& mine = *data_;
+			auto const& theirs = *other.data_;
+			if (&mine == &theirs) {
+				return true;
+			}
+			if (mine.nodes.size() != theirs.nodes.size() or mine.edges.size() != theirs.edges.size()) {
+				return false;
+			}
+			auto my_fingerprint = fingerprint_.load(std::memory_order_relaxed);
+			auto their_fingerprint = other.fingerprint_.load(std::memory_order_relaxed);
+			if (my_fingerprint != 0 and their_fingerprint != 0 and my_fingerprint != their_fingerprint) {
+				return false;
+			}
+			auto same = [](stored_edge const& a, stored_edge const& b) {
+				return *a.src == *b.src and *a.dst == *b.dst and a.weight == b.weight;
+			};
+			probe::scanned(mine.edges.size());
+			return std::equal(mine.nodes.begin(), mine.nodes.end(), theirs.nodes.begin())
+			       and std::equal(mine.edges.begin(), mine.edges.end(), theirs.edges.begin(), same);
+		}
+
+		// hash of the nodes and edges, equal graphs have equal fingerprints. It is computed on first use
+		// and kept until the graph is modified, which is what lets operator== reject in O(1)
+		[[nodiscard]] auto fingerprint() const -> std::size_t
+		requires std::is_default_constructible_v<std::hash<N>>
+		         and (std::is_void_v<E> or std::is_default_constructible_v<std::hash<weight_t<E>>>)
+		{
+			auto const measure = probe{*this, graph_op::fingerprint};
+			if (auto known = fingerprint_.load(std::memory_order_relaxed); known != 0) {
+				return known;
+			}
+			auto h = std::size_t{data_->nodes.size()};
+			probe::scanned(data_->edges.size());
+			auto mix = [&h](std::size_t v) { h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2); };
+			for (auto const& n : data_->nodes) {
+				mix(std::hash<N>{}(n));
+			}
+			for (auto const& e : data_->edges) {
+				mix(std::hash<N>{}(*e.src));
+				mix(std::hash<N>{}(*e.dst));
+				if constexpr (not std::is_void_v<E>) {
+					mix(std::hash<weight_t<E>>{}(e.weight));
+				}
+			}
+			// zero means not yet computed
+			h = h == 0 ? 1 : h;
+			fingerprint_.store(h, std::memory_order_relaxed);
+			return h;
+		}
+
+		// Instrumentation, totals per operation since construction or the last reset. Only the
+		// outermost operation is measured, one that calls another is charged for both
+		[[nodiscard]] auto stats() const noexcept -> graph_stats
+		requires Instrument::enabled
+		{
+			return instrument_.stats();
+		}
+
+		// where on_operation() and reset() are found
+		[[nodiscard]] auto instrumentation() const noexcept -> Instrument&
+		requires Instrument::enabled
+		{
+			return instrument_;
+		}
+
+		// Extractor, nodes and edges share the same order so both are walked once in lockstep
+		friend auto operator<<(std::ostream& os, graph const& g) noexcept -> std::ostream& {
+			auto const measure = probe{g, graph_op::print};
+			probe::scanned(g.data_->edges.size());
+			os << "\n";
+			auto e = g.data_->edges.begin();
+			for (auto const& n : g.data_->nodes) {
+				os << n << " (\n";
+				for (; e != g.data_->edges.end() and e->src == &n; ++e) {
+					os << "  ";
+					write_edge(os, n, *e->dst, e->weight);
+					os << "\n";
+				}
+				os << ")\n";
+			}
+			return os;
+		}
+
+	 private:
+		// edges are stored by value, contiguously, and never go through the edge interface internally.
+		// src and dst point at the node owned by nodes, std::set never moves its elements so these
+		// handles stay valid until the node is erased, and equal nodes always have equal handles
+		struct stored_edge {
+			N const* src;
+			N const* dst;
+			[[no_unique_address]] weight_t<E> weight;
+
+			friend auto operator==(stored_edge const&, stored_edge const&) -> bool = default;
+		};
+
+		// everything a graph owns, shared by copies of the graph until one of them is modified
+		struct storage {
+			std::pmr::set<N> nodes;
+			std::pmr::vector<stored_edge> edges;
+			[[no_unique_address]] NodeIndex index;
+			[[no_unique_address]] InIndex in;
+
+			explicit storage(allocator_type const& alloc)
+			: nodes(alloc)
+			, edges(alloc)
+			, index{std::make_obj_using_allocator<NodeIndex>(alloc)}
+			, in{std::make_obj_using_allocator<InIndex>(alloc)} {}
+
+			// the edges are rebound to the nodes owned by the copy
+			storage(storage const& other, allocator_type const& alloc)
+			: nodes(other.nodes, alloc)
+			, edges(other.edges, alloc)
+			, index{std::make_obj_using_allocator<NodeIndex>(alloc)}
+			, in{std::make_obj_using_allocator<InIndex>(alloc)} {
+				for (auto const& n : nodes) {
+					index.insert(&n);
+				}
+				auto rebind = std::unordered_map<N const*, N const*>{};
+				rebind.reserve(nodes.size());
+				for (auto n = nodes.begin(), o = other.nodes.begin(); n != nodes.end(); ++n, ++o) {
+					rebind.emplace(&*o, &*n);
+				}
+				for (auto& e : edges) {
+					e.src = rebind[e.src];
+					e.dst = rebind[e.dst];
+				}
+				in.assign(edges);
+			}
+		};
+
+		allocator_type alloc_;
+		// never null, an empty graph that hasn't been modified shares one storage with every other
+		std::shared_ptr<storage> data_;
+		// 0 until fingerprint() is called, every change to the graph sets it back
+		mutable std::atomic<std::size_t> fingerprint_ = 0;
+		// recording is part of reading the graph, so const members record as well
+		[[no_unique_address]] mutable Instrument instrument_;
+
+		// measures the public operation it is made at the start of, if it is the outermost one running
+		// on this thread: the latency, the growth of the storage and whatever scanned() and sorted()
+		// report meanwhile, which is handed to the Instrument at the end. It is empty, and every member
+		// does nothing, without instrumentation
+		class probe {
+		 public:
+			probe(graph const& g, graph_op op) noexcept {
+				if constexpr (Instrument::enabled) {
+					if (active_ == nullptr) {
+						active_ = this;
+						state_.g = &g;
+						state_.sample.op = op;
+						state_.start = std::chrono::steady_clock::now();
+						state_.data = g.data_.get();
+						state_.nodes = g.data_->nodes.size();
+						state_.capacity = g.data_->edges.capacity();
+					}
+				}
+			}
+
+			probe(probe const&) = delete;
+			auto operator=(probe const&) -> probe& = delete;
+
+			~probe() {
+				if constexpr (Instrument::enabled) {
+					if (active_ == this) {
+						active_ = nullptr;
+						auto& sample = state_.sample;
+						auto const& now = *state_.g->data_;
+						sample.latency = std::chrono::steady_clock::now() - state_.start;
+						if (&now != state_.data) {
+							// copied on write, or dropped by clear()
+							auto fresh = state_.g->data_ != empty_storage() ? std::size_t{1} : 0;
+							sample.allocations += fresh + now.nodes.size() + (now.edges.capacity() != 0 ? 1U : 0U);
+						}
+						else {
+							sample.allocations += now.nodes.size() > state_.nodes ? now.nodes.size() - state_.nodes : 0;
+							sample.allocations += now.edges.capacity() != state_.capacity ? 1U : 0U;
+						}
+						state_.g->instrument_.record(sample);
+					}
+				}
+			}
+
+			static void scanned(std::size_t edges) noexcept {
+				if constexpr (Instrument::enabled) {
+					if (active_ != nullptr) {
+						active_->state_.sample.edges_scanned += edges;
+					}
+				}
+			}
+
+			static void sorted() noexcept {
+				if constexpr (Instrument::enabled) {
+					if (active_ != nullptr) {
+						++active_->state_.sample.sorts;
+					}
+				}
+			}
+
+		 private:
+			struct state {
+				graph const* g;
+				op_sample sample;
+				std::chrono::steady_clock::time_point start;
+				storage const* data;
+				std::size_t nodes;
+				std::size_t capacity;
+			};
+			struct no_state {};
+			[[no_unique_address]] std::conditional_t<Instrument::enabled, state, no_state> state_{};
+
+			static inline thread_local probe* active_ = nullptr;
+		};
+
+		static auto empty_storage() noexcept -> std::shared_ptr<storage> const& {
+			static auto const empty = std::make_shared<storage>(allocator_type{std::pmr::new_delete_resource()});
+			return empty;
+		}
+
+		// the storage of this graph alone, copied first if another graph shares it. Handles into shared
+		// storage don't survive the copy, so a modification either starts here or uses own_found()
+		auto own() -> storage& {
+			if (data_.use_count() > 1) {
+				probe::scanned(data_->edges.size());
+				data_ = std::allocate_shared<storage>(alloc_, *data_, alloc_);
+			}
+			else {
+				// use_count() is a relaxed load, the fence orders our writes after every read made by
+				// a copy on another thread whose release of the storage brought the count down to one
+				std::atomic_thread_fence(std::memory_order_acquire);
+			}
+			return *data_;
+		}
+
+		// own() for a modification that has looked up what it needs and is certain to change the graph,
+		// so a call that throws or changes nothing leaves shared storage shared. True if the storage was
+		// copied, in which case whatever was found has to be found again in the copy
+		auto own_found() -> bool {
+			auto const copied = data_.use_count() > 1;
+			own();
+			return copied;
+		}
+
+		// own() for edges resolved against storage that may be shared, their ends are moved to the copy if it was
+		template<typename ExecutionPolicy>
+		void rehome(ExecutionPolicy&& policy, std::vector<stored_edge>& edges) {
+			if (data_.use_count() > 1) {
+				// the old storage is held until the ends are moved, another graph may let go of it meanwhile
+				auto const shared = data_;
+				own();
+				std::for_each(policy, edges.begin(), edges.end(), [this](stored_edge& e) {
+					e.src = find_node(*e.src);
+					e.dst = find_node(*e.dst);
+				});
+			}
+			else {
+				own();
+			}
+		}
+
+		void modified() noexcept {
+			fingerprint_.store(0, std::memory_order_relaxed);
+		}
+
+		void index_nodes() {
+			for (auto const& n : data_->nodes) {
+				data_->index.insert(&n);
+			}
+		}
+
+		// ordering of the edges stored in graph: by src, then dst, then weight
+		struct edge_less {
+			auto operator()(stored_edge const& a, stored_edge const& b) const -> bool {
+				if (a.src != b.src) {
+					return *a.src < *b.src;
+				}
+				if (a.dst != b.dst) {
+					return *a.dst < *b.dst;
+				}
+				return a.weight < b.weight;
+			}
+		};
+
+		struct weight_less {
+			auto operator()(stored_edge const& a, weight_t<E> const& w) const -> bool {
+				return a.weight < w;
+			}
+		};
+
+		// an element of the range given to insert_edges, with its nodes looked up
+		template<typename Edge>
+		auto to_stored_edge(Edge const& e) const noexcept -> stored_edge {
+			if constexpr (std::is_void_v<E>) {
+				auto const& [src, dst] = e;
+				return stored_edge{find_node(src), find_node(dst), {}};
+			}
+			else {
+				auto const& [src, dst, weight] = e;
+				return stored_edge{find_node(src), find_node(dst), weight_t<E>{weight}};
+			}
+		}
+
+		// ranges of tuples or pairs of N whose ends stay put while insert_edges reads them, under the
+		// ordered index where every lookup is a search of the node set
+		template<typename It>
+		static constexpr auto resolvable_in_order = [] {
+			if constexpr (std::random_access_iterator<It> and std::is_same_v<NodeIndex, ordered_node_index<N>>) {
+				if constexpr (requires(It it) {
+					              std::get<0>(*it);
+					              std::get<1>(*it);
+				              })
+				{
+					using src = decltype(std::get<0>(*std::declval<It>()));
+					using dst = decltype(std::get<1>(*std::declval<It>()));
+					return std::is_lvalue_reference_v<src> and std::is_lvalue_reference_v<dst>
+					       and std::is_same_v<std::remove_cvref_t<src>, N> and std::is_same_v<std::remove_cvref_t<dst>, N>;
+				}
+			}
+			return false;
+		}();
+
+		// the range as stored edges, its ends looked up by sorting them and walking the node set once in
+		// order. A search per end takes a random path down the tree, most of it out of cache once the
+		// graph is large
+		template<typename RandomIt>
+		auto resolve_in_order(RandomIt first, RandomIt last) const -> std::vector<stored_edge> {
+			// arithmetic nodes are sorted by value, the rest through a pointer to the end in the range
+			using key = std::conditional_t<std::is_arithmetic_v<N>, N, N const*>;
+			auto value_of = [](key const& k) -> N const& {
+				if constexpr (std::is_arithmetic_v<N>) {
+					return k;
+				}
+				else {
+					return *k;
+				}
+			};
+			auto res = std::vector<stored_edge>{};
+			auto ends = std::vector<std::pair<key, std::size_t>>{};
+			res.reserve(static_cast<std::size_t>(last - first));
+			ends.reserve(2 * res.capacity());
+			for (; first != last; ++first) {
+				auto const& src = std::get<0>(*first);
+				auto const& dst = std::get<1>(*first);
+				if constexpr (std::is_arithmetic_v<N>) {
+					ends.emplace_back(src, 2 * res.size());
+					ends.emplace_back(dst, 2 * res.size() + 1);
+				}
+				else {
+					ends.emplace_back(&src, 2 * res.size());
+					ends.emplace_back(&dst, 2 * res.size() + 1);
+				}
+				if constexpr (std::is_void_v<E>) {
+					res.push_back(stored_edge{nullptr, nullptr, {}});
+				}
+				else {
+					res.push_back(stored_edge{nullptr, nullptr, weight_t<E>{std::get<2>(*first)}});
+				}
+			}
+			std::sort(ends.begin(), ends.end(), [&value_of](auto const& a, auto const& b) {
+				return value_of(a.first) < value_of(b.first);
+			});
+			auto node = data_->nodes.begin();
+			for (auto const& [k, slot] : ends) {
+				auto const& value = value_of(k);
+				while (node != data_->nodes.end() and *node < value) {
+					++node;
+				}
+				auto handle = node != data_->nodes.end() and not(value < *node) ? &*node : nullptr;
+				auto& e = res[slot / 2];
+				(slot % 2 == 0 ? e.src : e.dst) = handle;
+			}
+			probe::sorted();
+			return res;
+		}
+
+		// integer nodes and weights order the same as their bytes do, once the sign bit is flipped,
+		// so a large batch of edges sequenced by the caller is radix sorted rather than compared
+		static constexpr auto radix_sortable = std::is_integral_v<N> and not std::is_same_v<N, bool>
+		                                       and (std::is_void_v<E>
+		                                            or (std::is_integral_v<E> and not std::is_same_v<E, bool>));
+		static constexpr auto radix_threshold = std::size_t{256};
+
+		// sorts edges into the order of edge_less
+		template<typename ExecutionPolicy>
+		static void sort_edges(ExecutionPolicy&& policy, std::vector<stored_edge>& edges) {
+			using policy_type = std::remove_cvref_t<ExecutionPolicy>;
+			if constexpr (radix_sortable and std::is_same_v<policy_type, std::execution::sequenced_policy>) {
+				if (edges.size() >= radix_threshold) {
+					probe::sorted();
+					radix_sort(edges);
+					return;
+				}
+			}
+			probe::sorted();
+			std::sort(policy, edges.begin(), edges.end(), edge_less{});
+		}
+
+		template<typename T>
+		static auto radix_key(T value) noexcept -> std::uint64_t {
+			auto key = static_cast<std::uint64_t>(static_cast<std::make_unsigned_t<T>>(value));
+			if constexpr (std::is_signed_v<T>) {
+				key ^= std::uint64_t{1} << (sizeof(T) * 8 - 1);
+			}
+			return key;
+		}
+
+		// least significant digit first, every pass a stable counting sort on one byte of a key: the
+		// weight, whether there is a weight, the dst and last the src. A byte that is the same for every
+		// edge leaves the order as it is, so that pass is skipped
+		static void radix_sort(std::vector<stored_edge>& edges) requires radix_sortable {
+			auto buffer = std::vector<stored_edge>(edges.size());
+			auto pass = [&](auto key, std::size_t shift) {
+				auto starts = std::array<std::size_t, 257>{};
+				for (auto const& e : edges) {
+					++starts[((key(e) >> shift) & 0xFF) + 1];
+				}
+				if (std::find(starts.begin(), starts.end(), edges.size()) != starts.end()) {
+					return;
+				}
+				std::partial_sum(starts.begin(), starts.end(), starts.begin());
+				for (auto& e : edges) {
+					buffer[starts[(key(e) >> shift) & 0xFF]++] = std::move(e);
+				}
+				edges.swap(buffer);
+			};
+			auto passes = [&](auto key, std::size_t bytes) {
+				for (auto byte = std::size_t{0}; byte != bytes; ++byte) {
+					pass(key, byte * 8);
+				}
+			};
+			if constexpr (not std::is_void_v<E>) {
+				passes([](stored_edge const& e) { return e.weight ? radix_key(*e.weight) : 0; }, sizeof(E));
+				pass([](stored_edge const& e) { return std::uint64_t{e.weight.has_value()}; }, 0);
+			}
+			passes([](stored_edge const& e) { return radix_key(*e.dst); }, sizeof(N));
+			passes([](stored_edge const& e) { return radix_key(*e.src); }, sizeof(N));
+		}
+
+		// helpers for insert_node and replace_node. The ordered index is the set itself, so insert() is
+		// the only search. Any other index rules out a node that is already there without the tree
+		template<typename Value>
+		auto add_node(Value&& value) -> bool {
+			auto const measure = probe{*this, graph_op::insert_node};
+			// the ordered index finds a duplicate in the insert itself, unless the insert would copy the storage
+			if (data_.use_count() > 1 or not std::is_same_v<NodeIndex, ordered_node_index<N>>) {
+				if (is_node(value)) {
+					return false;
+				}
+			}
+			own();
+			auto [node, inserted] = data_->nodes.insert(std::forward<Value>(value));
+			if (inserted) {
+				data_->index.insert(&*node);
+				modified();
+			}
+			return inserted;
+		}
+
+		template<typename Value>
+		auto relabel_node(N const& old_data, Value&& new_data) -> bool {
+			auto const measure = probe{*this, graph_op::replace_node};
+			auto old_node = find_node(old_data);
+			if (old_node != nullptr) {
+				if (not is_node(new_data)) {
+					if (own_found()) {
+						old_node = find_node(old_data);
+					}
+					// where the incident edges are has to be known before the new value breaks the order
+					modified();
+					auto incident = std::vector<incident_block>{};
+					if constexpr (InIndex::enabled) {
+						incident = incident_blocks(old_node);
+					}
+					// built before the node is detached, with the allocator of the nodes so that moving it in
+					// doesn't allocate, and a throwing copy leaves the graph as it was
+					auto value =
+					    std::make_obj_using_allocator<N>(data_->nodes.get_allocator(), std::forward<Value>(new_data));
+					// the node keeps its address when relabelled through a node handle,
+					// so every edge referring to it sees the new value
+					data_->index.erase(old_node);
+					auto handle = data_->nodes.extract(old_data);
+					try {
+						handle.value() = std::move(value);
+					} catch (...) {
+						// the index just lost this entry, so putting it back can't grow it
+						data_->index.insert(&*data_->nodes.insert(std::move(handle)).position);
+						throw;
+					}
+					auto node = &*data_->nodes.insert(std::move(handle)).position;
+					data_->index.insert(node);
+					if constexpr (InIndex::enabled) {
+						reorder(node, incident);
+					}
+					else {
+						relabel([node](N const* n) { return n == node ? node : nullptr; });
+					}
+					return true;
+				}
+				return false;
+			}
+			auto emsg = std::string{"Cannot call gdwg::graph<N, E>::replace_node on a node that doesn't exist"};
+			throw std::runtime_error{emsg};
+		}
+
+
+		// sorts and dedups new_edges, then merges them into edges in one pass,
+		// returns the number of edges that were not already in the graph
+		auto merge_edges(std::vector<stored_edge> new_edges) -> std::size_t {
+			return merge_edges(std::execution::seq, std::move(new_edges));
+		}
+
+		template<typename ExecutionPolicy>
+		auto merge_edges(ExecutionPolicy&& policy, std::vector<stored_edge> new_edges) -> std::size_t {
+			modified();
+			auto& edges = data_->edges;
+			sort_edges(policy, new_edges);
+			auto old_size = edges.size();
+			probe::scanned(old_size + new_edges.size());
+			auto new_last = std::unique(policy, new_edges.begin(), new_edges.end());
+			// only the edges not already in the graph go on, so the index is given just those
+			if (old_size != 0) {
+				new_last = std::remove_if(policy, new_edges.begin(), new_last, [&edges](stored_edge const& e) {
+					return std::binary_search(edges.begin(), edges.end(), e, edge_less{});
+				});
+			}
+			edges.insert(edges.end(), std::make_move_iterator(new_edges.begin()), std::make_move_iterator(new_last));
+			auto middle = edges.begin() + static_cast<std::ptrdiff_t>(old_size);
+			// as in insert_edge the edges go in before the index, and both are undone if it throws
+			auto indexed = middle;
+			try {
+				for (; indexed != edges.end(); ++indexed) {
+					data_->in.push(indexed->src, indexed->dst, indexed->weight);
+				}
+			} catch (...) {
+				for (auto e = middle; e != indexed; ++e) {
+					data_->in.erase(e->src, e->dst, e->weight);
+				}
+				edges.erase(middle, edges.end());
+				throw;
+			}
+			std::inplace_merge(policy, edges.begin(), middle, edges.end(), edge_less{});
+			return edges.size() - old_size;
+		}
+
+		template<typename ExecutionPolicy, typename ForwardIt>
+		static auto sorted_nodes(ExecutionPolicy&& policy, ForwardIt first, ForwardIt last) -> std::vector<N> {
+			auto sorted = std::vector<N>(first, last);
+			std::sort(policy, sorted.begin(), sorted.end());
+			sorted.erase(std::unique(policy, sorted.begin(), sorted.end()), sorted.end());
+			return sorted;
+		}
+
+		graph(std::vector<N> sorted, allocator_type const& alloc)
+		: graph(sorted_unique, std::make_move_iterator(sorted.begin()), std::make_move_iterator(sorted.end()), alloc) {}
+
+		// helper function for replace_node, merge_replace and transactions, target maps a node to
+		// the node its edges now belong to, or to nullptr if its edges are untouched. One pass compacts
+		// the untouched edges (still sorted) to the front and sets the touched edges aside relabelled,
+		// only those are sorted, then both are merged from the back into the space the touched edges left
+		template<typename Target>
+		void relabel(Target target) {
+			auto touched = std::vector<stored_edge>{};
+			auto kept = data_->edges.begin();
+			probe::scanned(data_->edges.size());
+			for (auto e = data_->edges.begin(); e != data_->edges.end(); ++e) {
+				auto src = target(e->src);
+				auto dst = target(e->dst);
+				if (src != nullptr or dst != nullptr) {
+					if ((src != nullptr and src != e->src) or (dst != nullptr and dst != e->dst)) {
+						data_->in.erase(e->src, e->dst, e->weight);
+						data_->in.insert(src ? src : e->src, dst ? dst : e->dst, e->weight);
+					}
+					touched.push_back(stored_edge{src ? src : e->src, dst ? dst : e->dst, std::move(e->weight)});
+				}
+				else {
+					if (kept != e) {
+						*kept = std::move(*e);
+					}
+					++kept;
+				}
+			}
+			sort_edges(std::execution::seq, touched);
+			// on ties the untouched edge is placed first, so it is the one unique() keeps
+			auto out = data_->edges.end();
+			for (auto t = touched.end(); t != touched.begin();) {
+				if (kept != data_->edges.begin() and edge_less{}(t[-1], kept[-1])) {
+					*--out = std::move(*--kept);
+				}
+				else {
+					*--out = std::move(*--t);
+				}
+			}
+		}
+
+		// the edges into node ordered by src then weight, from the reverse index or a scan of every edge
+		auto in_edge_list(N const* node) const -> std::vector<stored_edge> {
+			auto res = std::vector<stored_edge>{};
+			if constexpr (InIndex::enabled) {
+				for (auto const& e : data_->in.of(node)) {
+					res.push_back(stored_edge{e.src, node, e.weight});
+				}
+				sort_edges(std::execution::seq, res);
+			}
+			else {
+				probe::scanned(data_->edges.size());
+				std::copy_if(data_->edges.begin(), data_->edges.end(), std::back_inserter(res), [node](stored_edge const& e) {
+					return e.dst == node;
+				});
+			}
+			return res;
+		}
+
+		// positions in edges of the edges that one src has into a node, and of the whole block of edges
+		// out of that src
+		struct incident_block {
+			std::size_t first;
+			std::size_t last;
+			std::size_t block_first;
+			std::size_t block_last;
+		};
+
+		// the edges incident to node, found through the reverse index while edges is still ordered. The
+		// first block is the edges out of node, self loops included, the rest hold the edges into it
+		auto incident_blocks(N const* node) const -> std::vector<incident_block> {
+			auto at = [this](store_iterator it) { return static_cast<std::size_t>(it - data_->edges.begin()); };
+			auto out = edge_range(*node);
+			auto blocks = std::vector<incident_block>{{at(out.first), at(out.second), at(out.first), at(out.second)}};
+			for (auto const& e : data_->in.of(node)) {
+				if (e.src != node) {
+					auto block = edge_range(*e.src);
+					auto range = edge_range(*e.src, *node);
+					blocks.push_back(incident_block{at(range.first), at(range.second), at(block.first), at(block.second)});
+				}
+			}
+			// a src with several weighted edges into node shows up once per edge
+			auto by_first = [](auto const& x, auto const& y) { return x.first < y.first; };
+			auto same_first = [](auto const& x, auto const& y) { return x.first == y.first; };
+			std::sort(blocks.begin() + 1, blocks.end(), by_first);
+			blocks.erase(std::unique(blocks.begin() + 1, blocks.end(), same_first), blocks.end());
+			return blocks;
+		}
+
+		// restores the order of edges once node, whose blocks these are, changed value in place. The
+		// edges into it only move within the block of their src, then its own block is sorted and moved
+		// as a whole, so nothing but incident edges is compared
+		void reorder(N const* node, std::vector<incident_block> const& blocks) {
+			auto at = [this](std::size_t i) { return data_->edges.begin() + static_cast<std::ptrdiff_t>(i); };
+			auto move_to_order = [&node](auto block_first, auto first, auto last, auto block_last, auto less) {
+				auto pos = std::lower_bound(block_first, first, *node, less);
+				if (pos != first) {
+					std::rotate(pos, first, last);
+				}
+				else {
+					std::rotate(first, last, std::lower_bound(last, block_last, *node, less));
+				}
+			};
+			auto by_dst = [](stored_edge const& e, N const& v) { return *e.dst < v; };
+			for (auto b = std::next(blocks.begin()); b != blocks.end(); ++b) {
+				move_to_order(at(b->block_first), at(b->first), at(b->last), at(b->block_last), by_dst);
+			}
+			auto const& own = blocks.front();
+			probe::sorted();
+			std::sort(at(own.first), at(own.last), edge_less{});
+			auto by_src = [](stored_edge const& e, N const& v) { return *e.src < v; };
+			move_to_order(data_->edges.begin(), at(own.first), at(own.last), data_->edges.end(), by_src);
+		}
+
+		// operations buffered by a transaction
+		struct insert_node_op {
+			N value;
+		};
+		struct insert_edge_op {
+			N src;
+			N dst;
+			weight_t<E> weight;
+		};
+		struct erase_edge_op {
+			N src;
+			N dst;
+			weight_t<E> weight;
+		};
+		struct erase_node_op {
+			N value;
+		};
+		struct replace_node_op {
+			N old_data;
+			N new_data;
+		};
+		struct merge_replace_node_op {
+			N old_data;
+			N new_data;
+		};
+		using operation = std::
+		    variant<insert_node_op, insert_edge_op, erase_edge_op, erase_node_op, replace_node_op, merge_replace_node_op>;
+
+		// replays which nodes exist through ops, throwing what the first failing operation would throw
+		void validate(std::vector<operation> const& ops) const {
+			auto overlay = std::map<N, bool>{};
+			auto present = [this, &overlay](N const& value) {
+				auto it = overlay.find(value);
+				return it != overlay.end() ? it->second : is_node(value);
+			};
+			for (auto const& op : ops) {
+				if (auto const* o = std::get_if<insert_node_op>(&op)) {
+					overlay[o->value] = true;
+				}
+				else if (auto const* o = std::get_if<erase_node_op>(&op)) {
+					overlay[o->value] = false;
+				}
+				else if (auto const* o = std::get_if<insert_edge_op>(&op); o and not(present(o->src) and present(o->dst))) {
+					auto emsg = std::string{"Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does "
+					                        "not exist"};
+					throw std::runtime_error{emsg};
+				}
+				else if (auto const* o = std::get_if<erase_edge_op>(&op); o and not(present(o->src) and present(o->dst))) {
+					auto emsg = std::string{"Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't exist "
+					                        "in the graph"};
+					throw std::runtime_error{emsg};
+				}
+				else if (auto const* o = std::get_if<replace_node_op>(&op)) {
+					if (not present(o->old_data)) {
+						auto emsg = std::string{"Cannot call gdwg::graph<N, E>::replace_node on a node that doesn't exist"};
+						throw std::runtime_error{emsg};
+					}
+					if (not present(o->new_data)) {
+						overlay[o->old_data] = false;
+						overlay[o->new_data] = true;
+					}
+				}
+				else if (auto const* o = std::get_if<merge_replace_node_op>(&op);
+				         o and not(present(o->old_data) and present(o->new_data))) {
+					auto emsg = std::string{"Cannot call gdwg::graph<N, E>::merge_replace_node on old or new data if "
+					                        "they don't exist in the graph"};
+					throw std::runtime_error{emsg};
+				}
+			}
+		}
+
+		// applies ops that validate() accepted. Node changes happen as they come, edge changes are
+		// gathered while consecutive operations are of the same kind and then applied in one pass:
+		// one merge for a run of inserts, one compaction for a run of edge or node erasures and one
+		// relabel for a run of replace and merge_replace
+		void apply(std::vector<operation> const& ops) {
+			auto const measure = probe{*this, graph_op::commit};
+			own();
+			modified();
+			auto inserted = std::vector<stored_edge>{};
+			auto erased = std::vector<stored_edge>{};
+			// erased nodes are held here so handles to them stay valid until their edges are gone
+			auto graveyard = std::vector<typename std::pmr::set<N>::node_type>{};
+			auto targets = std::unordered_map<N const*, N const*>{};
+			auto merged = false;
+			auto flush = [&]() {
+				if (not inserted.empty()) {
+					merge_edges(std::exchange(inserted, {}));
+				}
+				if (not erased.empty()) {
+					sort_edges(std::execution::seq, erased);
+					probe::scanned(data_->edges.size());
+					for (auto const& e : erased) {
+						data_->in.erase(e.src, e.dst, e.weight);
+					}
+					std::erase_if(data_->edges, [&erased](stored_edge const& e) {
+						return std::binary_search(erased.begin(), erased.end(), e, edge_less{});
+					});
+					erased.clear();
+				}
+				if (not graveyard.empty()) {
+					auto dead = std::unordered_set<N const*>{};
+					for (auto const& handle : graveyard) {
+						dead.insert(&handle.value());
+						data_->in.forget(&handle.value());
+					}
+					probe::scanned(data_->edges.size());
+					for (auto const& e : data_->edges) {
+						if (dead.contains(e.src) and not dead.contains(e.dst)) {
+							data_->in.erase(e.src, e.dst, e.weight);
+						}
+					}
+					std::erase_if(data_->edges, [&dead](stored_edge const& e) {
+						return dead.contains(e.src) or dead.contains(e.dst);
+					});
+					graveyard.clear();
+				}
+				if (not targets.empty()) {
+					relabel([&targets](N const* n) {
+						auto it = targets.find(n);
+						return it == targets.end() ? nullptr : it->second;
+					});
+					if (merged) {
+						data_->edges.erase(std::unique(data_->edges.begin(), data_->edges.end()), data_->edges.end());
+					}
+					targets.clear();
+					merged = false;
+				}
+			};
+			// replace_node and merge_replace_node share a run, insert_node never ends one
+			auto run_of = [](operation const& op) -> std::size_t {
+				return std::holds_alternative<merge_replace_node_op>(op) ? op.index() - 1 : op.index();
+			};
+			auto run = std::variant_npos;
+			for (auto const& op : ops) {
+				if (not std::holds_alternative<insert_node_op>(op) and run_of(op) != run) {
+					flush();
+					run = run_of(op);
+				}
+				if (auto const* o = std::get_if<insert_node_op>(&op)) {
+					insert_node(o->value);
+				}
+				else if (auto const* o = std::get_if<insert_edge_op>(&op)) {
+					inserted.push_back(stored_edge{find_node(o->src), find_node(o->dst), o->weight});
+				}
+				else if (auto const* o = std::get_if<erase_edge_op>(&op)) {
+					erased.push_back(stored_edge{find_node(o->src), find_node(o->dst), o->weight});
+				}
+				else if (auto const* o = std::get_if<erase_node_op>(&op)) {
+					if (auto node = find_node(o->value); node != nullptr) {
+						data_->index.erase(node);
+						graveyard.push_back(data_->nodes.extract(o->value));
+					}
+				}
+				else if (auto const* o = std::get_if<replace_node_op>(&op)) {
+					if (not is_node(o->new_data)) {
+						auto node = find_node(o->old_data);
+						data_->index.erase(node);
+						auto handle = data_->nodes.extract(o->old_data);
+						handle.value() = o->new_data;
+						data_->nodes.insert(std::move(handle));
+						data_->index.insert(node);
+						targets.try_emplace(node, node);
+					}
+				}
+				else if (auto const* o = std::get_if<merge_replace_node_op>(&op)) {
+					auto old_node = find_node(o->old_data);
+					auto new_node = find_node(o->new_data);
+					for (auto& [from, to] : targets) {
+						if (to == old_node) {
+							to = new_node;
+						}
+					}
+					// a node merged earlier in the run has no edges left, one only renamed still has its own
+					auto [it, fresh] = targets.try_emplace(old_node, new_node);
+					if (not fresh and it->second == old_node) {
+						it->second = new_node;
+					}
+					merged = true;
+				}
+			}
+			flush();
+		}
+
+		// helper functions for binary searching the sorted edges by src, and by (src, dst)
+		auto edge_range(N const& src) const noexcept -> std::pair<store_iterator, store_iterator> {
+			auto const& edges = data_->edges;
+			auto first = std::lower_bound(edges.begin(), edges.end(), src, [](stored_edge const& a, N const& v) {
+				return *a.src < v;
+			});
+			auto last = std::upper_bound(first, edges.end(), src, [](N const& v, stored_edge const& a) {
+				return v < *a.src;
+			});
+			return {first, last};
+		}
+
+		auto edge_range(N const& src, N const& dst) const noexcept -> std::pair<store_iterator, store_iterator> {
+			auto range = edge_range(src);
+			auto first = std::lower_bound(range.first, range.second, dst, [](stored_edge const& a, N const& v) {
+				return *a.dst < v;
+			});
+			auto last = std::upper_bound(first, range.second, dst, [](N const& v, stored_edge const& a) {
+				return v < *a.dst;
+			});
+			return {first, last};
+		}
+	};
+
+	// graph with O(1) expected node lookups, for lookup heavy use that doesn't need ordered search
+	template<typename N, typename E, typename Hash = std::hash<N>, typename KeyEqual = std::equal_to<N>>
+	using unordered_graph = graph<N, E, hashed_node_index<N, Hash, KeyEqual>>;
+
+	// graph that also indexes the edges into every node, for in_connections() and in_edges() heavy use
+	template<typename N, typename E, typename NodeIndex = ordered_node_index<N>>
+	using bidirectional_graph = graph<N, E, NodeIndex, in_edge_index<N, E>>;
+
+	// the changes that turn from into to, so that from.apply(diff(from, to)) == to. Nodes and edges
+	// are both kept in order, so each is a single merge of the two graphs, O(V + E)
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+	auto diff(graph<N, E, NodeIndex, InIndex, Instrument> const& from,
+	          graph<N, E, NodeIndex, InIndex, Instrument> const& to) -> graph_delta<N, E> {
+		auto delta = graph_delta<N, E>{};
+		auto const from_nodes = from.nodes_view();
+		auto const to_nodes = to.nodes_view();
+		std::set_difference(to_nodes.begin(),
+		                    to_nodes.end(),
+		                    from_nodes.begin(),
+		                    from_nodes.end(),
+		                    std::back_inserter(delta.added_nodes));
+		std::set_difference(from_nodes.begin(),
+		                    from_nodes.end(),
+		                    to_nodes.begin(),
+		                    to_nodes.end(),
+		                    std::back_inserter(delta.removed_nodes));
+
+		auto key = [](auto const& e) { return std::tie(e.from, e.to, e.weight); };
+		auto f = from.begin();
+		auto t = to.begin();
+		while (f != from.end() or t != to.end()) {
+			if (t == to.end() or (f != from.end() and key(*f) < key(*t))) {
+				auto e = *f++;
+				if (to.is_node(e.from) and to.is_node(e.to)) {
+					delta.removed_edges.emplace_back(e.from, e.to, e.weight);
+				}
+			}
+			else if (f == from.end() or key(*t) < key(*f)) {
+				auto e = *t++;
+				delta.added_edges.emplace_back(e.from, e.to, e.weight);
+			}
+			else {
+				++f;
+				++t;
+			}
+		}
+		return delta;
+	}
+
+	// Buffers modifications to a graph and applies them together on commit(), as if each had been
+	// called on the graph in order. Consecutive modifications of the same kind share a single sort,
+	// merge or compaction of the edges. Either every modification is applied or, when one of them
+	// would throw for a missing node, none are and commit() throws that exception.
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+	class graph<N, E, NodeIndex, InIndex, Instrument>::transaction {
+	 public:
+		auto insert_node(N const& value) -> transaction& {
+			ops_.emplace_back(insert_node_op{value});
+			return *this;
+		}
+
+		auto insert_edge(N const& src, N const& dst, weight_t<E> weight = {}) -> transaction& {
+			ops_.emplace_back(insert_edge_op{src, dst, weight});
+			return *this;
+		}
+
+		auto replace_node(N const& old_data, N const& new_data) -> transaction& {
+			ops_.emplace_back(replace_node_op{old_data, new_data});
+			return *this;
+		}
+
+		auto merge_replace_node(N const& old_data, N const& new_data) -> transaction& {
+			ops_.emplace_back(merge_replace_node_op{old_data, new_data});
+			return *this;
+		}
+
+		auto erase_node(N const& value) -> transaction& {
+			ops_.emplace_back(erase_node_op{value});
+			return *this;
+		}
+
+		auto erase_edge(N const& src, N const& dst, weight_t<E> weight = {}) -> transaction& {
+			ops_.emplace_back(erase_edge_op{src, dst, weight});
+			return *this;
+		}
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t {
+			return ops_.size();
+		}
+
+		auto commit() -> void {
+			g_->validate(ops_);
+			g_->apply(ops_);
+			ops_.clear();
+		}
+
+		auto discard() noexcept -> void {
+			ops_.clear();
+		}
+
+	 private:
+		explicit transaction(graph& g) noexcept
+		: g_(&g) {}
+		graph* g_;
+		std::vector<operation> ops_;
+		friend class graph<N, E, NodeIndex, InIndex, Instrument>;
+	};
+
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+	class graph<N, E, NodeIndex, InIndex, Instrument>::edge_iterator {
+	 public:
+		using value_type = edge_handle<N, E>;
+		using reference = edge_handle<N, E>;
+		using pointer = void;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::bidirectional_iterator_tag;
+
+		// Iterator constructor
+		edge_iterator() = default;
+
+		// Iterator source
+		auto operator*() const noexcept -> reference {
+			return reference{*curr_->src, *curr_->dst, curr_->weight};
+		}
+
+		// Iterator traversal
+		auto operator++() noexcept -> edge_iterator& {
+			++curr_;
+			return *this;
+		}
+
+		auto operator++(int) noexcept -> edge_iterator {
+			auto copy{*this};
+			++(*this);
+			return copy;
+		}
+
+		auto operator--() noexcept -> edge_iterator& {
+			--curr_;
+			return *this;
+		}
+
+		auto operator--(int) noexcept -> edge_iterator {
+			auto copy{*this};
+			--(*this);
+			return copy;
+		}
+
+		// Iterator comparison
+		auto operator==(edge_iterator const& other) const noexcept -> bool {
+			return curr_ == other.curr_;
+		}
+
+	 private:
+		explicit edge_iterator(store_iterator curr)
+		: curr_(curr) {}
+		store_iterator curr_{};
+		friend class graph<N, E, NodeIndex, InIndex, Instrument>;
+	};
+
+	// walks the edges from one src, yielding each distinct dst once
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+	class graph<N, E, NodeIndex, InIndex, Instrument>::connection_iterator {
+	 public:
+		using value_type = N;
+		using reference = N const&;
+		using pointer = N const*;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::forward_iterator_tag;
+
+		// Iterator constructor
+		connection_iterator() = default;
+
+		// Iterator source
+		auto operator*() const noexcept -> reference {
+			return *curr_->dst;
+		}
+
+		auto operator->() const noexcept -> pointer {
+			return curr_->dst;
+		}
+
+		// Iterator traversal, the edges are ordered by dst so repeats are adjacent
+		auto operator++() noexcept -> connection_iterator& {
+			auto dst = curr_->dst;
+			while (++curr_ != last_ and curr_->dst == dst) {
+			}
+			return *this;
+		}
+
+		auto operator++(int) noexcept -> connection_iterator {
+			auto copy{*this};
+			++(*this);
+			return copy;
+		}
+
+		// Iterator comparison
+		auto operator==(connection_iterator const& other) const noexcept -> bool {
+			return curr_ == other.curr_;
+		}
+
+	 private:
+		connection_iterator(store_iterator curr, store_iterator last)
+		: curr_(curr)
+		, last_(last) {}
+		store_iterator curr_{};
+		store_iterator last_{};
+		friend class graph<N, E, NodeIndex, InIndex, Instrument>;
+	};
+
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+	class graph<N, E, NodeIndex, InIndex, Instrument>::iterator {
+	 public:
+		struct value_type {
+			N from;
+			N to;
+			weight_t<E> weight;
+		};
+
+		// refers to the stored edge, so dereferencing copies neither the nodes nor the weight
+		struct reference {
+			N const& from;
+			N const& to;
+			weight_t<E> const& weight;
+
+			operator value_type() const {
+				return value_type{from, to, weight};
+			}
+		};
+
+		using pointer = void;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::random_access_iterator_tag;
+
+		// Iterator constructor
+		iterator() = default;
+
+		// Iterator source
+		auto operator*() const noexcept -> reference {
+			return reference{*curr_->src, *curr_->dst, curr_->weight};
+		}
+
+		auto operator[](difference_type n) const noexcept -> reference {
+			return *(*this + n);
+		}
+
+		// Iterator traversal
+		auto operator++() noexcept -> iterator& {
+			++curr_;
+			return *this;
+		}
+
+		auto operator++(int) noexcept -> iterator {
+			auto copy{*this};
+			++(*this);
+			return copy;
+		}
+
+		auto operator--() noexcept -> iterator& {
+			--curr_;
+			return *this;
+		}
+
+		auto operator--(int) noexcept -> iterator {
+			auto copy{*this};
+			--(*this);
+			return copy;
+		}
+
+		auto operator+=(difference_type n) noexcept -> iterator& {
+			curr_ += n;
+			return *this;
+		}
+
+		auto operator-=(difference_type n) noexcept -> iterator& {
+			curr_ -= n;
+			return *this;
+		}
+
+		friend auto operator+(iterator i, difference_type n) noexcept -> iterator {
+			return i += n;
+		}
+
+		friend auto operator+(difference_type n, iterator i) noexcept -> iterator {
+			return i += n;
+		}
+
+		friend auto operator-(iterator i, difference_type n) noexcept -> iterator {
+			return i -= n;
+		}
+
+		friend auto operator-(iterator const& a, iterator const& b) noexcept -> difference_type {
+			return a.curr_ - b.curr_;
+		}
+
+		// Iterator comparison
+		auto operator==(iterator const& other) const noexcept -> bool {
+			return curr_ == other.curr_;
+		}
+
+		auto operator<=>(iterator const& other) const noexcept -> std::strong_ordering {
+			return curr_ <=> other.curr_;
+		}
+
+	 private:
+		explicit iterator(store_iterator curr)
+		: curr_(curr) {}
+		store_iterator curr_{};
+		friend class graph<N, E, NodeIndex, InIndex, Instrument>;
+	};
+
+	// a graph that keeps graph_stats of every operation made on it
+	template<typename N, typename E, typename NodeIndex = ordered_node_index<N>>
+	using instrumented_graph = graph<N, E, NodeIndex, no_in_edge_index<N, E>, counting_instrumentation>;
 } // namespace gdwg
 
 #endif // GDWG_GRAPH_H
@@ -2,6 +2,10 @@
 
 #include <catch2/catch.hpp>
 
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+
 TEST_CASE("Constructor work as expected") {
 	SECTION("default constructor") {
 		auto g = gdwg::graph<std::string, int>{};
@@ -16,6 +20,14 @@ TEST_CASE("Constructor work as expected") {
 		auto g = gdwg::graph<std::string, int>{v.begin(), v.end()};
 		CHECK(g.nodes().size() == 4);
 	}
+	SECTION("constructor with node and edge ranges") {
+		auto n = std::vector<int>{1, 2, 3};
+		auto e = std::vector<std::tuple<int, int, std::optional<int>>>{{2, 3, 4}, {1, 2, std::nullopt}, {2, 3, 4}};
+		auto g = gdwg::graph<int, int>{n.begin(), n.end(), e.begin(), e.end()};
+		CHECK(g.nodes().size() == 3);
+		CHECK(g.edges(2, 3).size() == 1);
+		CHECK(g.is_connected(1, 2));
+	}
 	SECTION("move and move-assign constructor") {
 		auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
 		auto move_g = gdwg::graph<std::string, int>{std::move(g)};
@@ -31,6 +43,14 @@ TEST_CASE("Constructor work as expected") {
 		CHECK(g.nodes() == copy_g.nodes());
 		auto copy_assign_g = g;
 		CHECK(copy_assign_g.nodes() == g.nodes());
+		// copies own their edges, so modifying one leaves the other untouched
+		g.insert_edge("A", "B", 1);
+		auto edge_copy_g = g;
+		CHECK(edge_copy_g.replace_node("A", "Z"));
+		CHECK(g.is_connected("A", "B"));
+		CHECK(g.edges("A", "B")[0]->get_nodes().first == "A");
+		CHECK(g.erase_node("B"));
+		CHECK(edge_copy_g.edges("Z", "B")[0]->print_edge() == "Z -> B | W | 1");
 	}
 }
 
@@ -79,6 +99,44 @@ TEST_CASE("Modifiers work as expected") {
 		CHECK(not g.insert_edge(3, 4, "A"));
 		CHECK(g.edges(3, 4).size() == 1);
 	}
+	SECTION("insert_edges") {
+		auto g = gdwg::graph<int, int>{1, 2, 3};
+		g.insert_edge(1, 2, 5);
+		auto e = std::vector<std::tuple<int, int, int>>{{3, 1, 2}, {1, 2, 5}, {1, 2, 4}, {3, 1, 2}};
+		CHECK(g.insert_edges(e.begin(), e.end()) == 2);
+		CHECK(g.edges(1, 2).size() == 2);
+		CHECK(g.edges(1, 2)[0]->get_weight() == 4);
+		auto bad = std::vector<std::tuple<int, int, int>>{{1, 3, 1}, {1, 9, 1}};
+		try {
+			g.insert_edges(bad.begin(), bad.end());
+		} catch (const std::runtime_error& err) {
+			CHECK(std::string(err.what())
+			      == "Cannot call gdwg::graph<N, E>::insert_edges when either src or dst node does not exist");
+		} catch (...) {
+			CHECK(false);
+		}
+		// nothing is inserted when a node is missing
+		CHECK(not g.is_connected(1, 3));
+	}
+	SECTION("insert_edges looks up the ends of a large batch in order") {
+		auto names = std::vector<std::string>{};
+		for (auto i = 0; i < 100; ++i) {
+			names.push_back("node " + std::to_string(i));
+		}
+		auto g = gdwg::graph<std::string, int>(names.begin(), names.end());
+		auto one_by_one = g;
+		auto e = std::vector<std::tuple<std::string, std::string, int>>{};
+		for (auto i = 0; i < 1000; ++i) {
+			e.emplace_back(names[static_cast<std::size_t>(i * 37 % 100)], names[static_cast<std::size_t>(i % 100)], i % 3);
+			one_by_one.insert_edge(std::get<0>(e.back()), std::get<1>(e.back()), i % 3);
+		}
+		CHECK(g.insert_edges(e.begin(), e.end()) == 300);
+		CHECK(g == one_by_one);
+		e.emplace_back("node 1", "missing", 0);
+		CHECK_THROWS_WITH(g.insert_edges(e.begin(), e.end()),
+		                  "Cannot call gdwg::graph<N, E>::insert_edges when either src or dst node does not exist");
+		CHECK(g == one_by_one);
+	}
 	SECTION("replace_node") {
 		auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
 		g.insert_edge("A", "B", 3);
@@ -99,6 +157,10 @@ TEST_CASE("Modifiers work as expected") {
 		CHECK(std::find(n.begin(), n.end(), "B") == n.end());
 		CHECK(edge_AT->get_nodes().second == "T");
 		CHECK(edge_TC->get_nodes().first == "T");
+		// edges are kept ordered by (src, dst, weight) after relabelling
+		CHECK(g.replace_node("A", "Z"));
+		auto const& [from, to, weight] = *g.begin();
+		CHECK((from == "T" and to == "C" and weight == 5));
 	}
 	SECTION("merge_replace_node") {
 		auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D"};
@@ -120,6 +182,28 @@ TEST_CASE("Modifiers work as expected") {
 		auto edge_BC = g.edges("B", "C")[0];
 		CHECK(edge_BB.size() == 1);
 		CHECK(edge_BC->get_nodes().first == "B");
+		CHECK(g.connections("B") == std::vector<std::string>{"B", "C", "D"});
+		CHECK(g.is_connected("B", "D"));
+	}
+	SECTION("merge_replace_node on a hub keeps edges sorted and unique") {
+		auto g = gdwg::graph<int, int>{};
+		auto expected = std::set<std::tuple<int, int, std::optional<int>>>{};
+		for (auto i = 0; i < 20; ++i) {
+			g.insert_node(i);
+		}
+		for (auto i = 0; i < 20; ++i) {
+			for (auto j = 0; j < 20; j += 3) {
+				g.insert_edge(i, j, (i + j) % 4);
+				auto relabel = [](int n) { return n == 0 ? 1 : n; };
+				expected.emplace(relabel(i), relabel(j), (i + j) % 4);
+			}
+		}
+		g.merge_replace_node(0, 1);
+		auto actual = std::vector<std::tuple<int, int, std::optional<int>>>{};
+		for (auto const& [from, to, weight] : g) {
+			actual.emplace_back(from, to, weight);
+		}
+		CHECK(actual == std::vector<std::tuple<int, int, std::optional<int>>>(expected.begin(), expected.end()));
 	}
 	SECTION("erase_node") {
 		auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
@@ -171,6 +255,81 @@ TEST_CASE("Modifiers work as expected") {
 	}
 }
 
+namespace {
+	// counts the copies made of it, moves are free
+	struct counted {
+		std::string name;
+		static inline auto copies = 0;
+
+		explicit counted(std::string n)
+		: name{std::move(n)} {}
+		counted(counted const& other)
+		: name{other.name} {
+			++copies;
+		}
+		counted(counted&&) noexcept = default;
+		auto operator=(counted const& other) -> counted& {
+			name = other.name;
+			++copies;
+			return *this;
+		}
+		auto operator=(counted&&) noexcept -> counted& = default;
+		~counted() = default;
+
+		friend auto operator<=>(counted const&, counted const&) = default;
+		friend auto operator<<(std::ostream& os, counted const& c) -> std::ostream& {
+			return os << c.name;
+		}
+	};
+} // namespace
+
+TEST_CASE("Values can be moved and built in place") {
+	counted::copies = 0;
+	auto g = gdwg::graph<counted, counted>{};
+	SECTION("insert_node") {
+		auto a = counted{"a long enough name to live on the heap"};
+		CHECK(g.insert_node(std::move(a)));
+		CHECK(a.name.empty());
+		auto again = counted{"a long enough name to live on the heap"};
+		CHECK(not g.insert_node(std::move(again)));
+		CHECK(again.name == "a long enough name to live on the heap");
+		CHECK(counted::copies == 0);
+	}
+	SECTION("emplace_node and emplace_edge") {
+		CHECK(g.emplace_node("A"));
+		CHECK(g.emplace_node("B"));
+		CHECK(not g.emplace_node("A"));
+		CHECK(g.emplace_edge(counted{"A"}, counted{"B"}, "w"));
+		CHECK(not g.emplace_edge(counted{"A"}, counted{"B"}, "w"));
+		CHECK(g.is_connected(counted{"A"}, counted{"B"}));
+		CHECK(counted::copies == 0);
+		CHECK(g.edges(counted{"A"}, counted{"B"}).size() == 1);
+	}
+	SECTION("replace_node") {
+		g.emplace_node("A");
+		g.emplace_node("B");
+		g.emplace_edge(counted{"A"}, counted{"B"}, "w");
+		auto c = counted{"C"};
+		CHECK(g.replace_node(counted{"A"}, std::move(c)));
+		auto b = counted{"B"};
+		CHECK(not g.replace_node(counted{"C"}, std::move(b)));
+		CHECK(b.name == "B");
+		CHECK(counted::copies == 0);
+		CHECK(g.is_connected(counted{"C"}, counted{"B"}));
+	}
+	SECTION("unordered_graph") {
+		auto u = gdwg::unordered_graph<std::string, int>{};
+		auto a = std::string(64, 'a');
+		CHECK(u.insert_node(std::move(a)));
+		CHECK(a.empty());
+		auto again = std::string(64, 'a');
+		CHECK(not u.insert_node(std::move(again)));
+		CHECK(again.size() == 64);
+		CHECK(u.emplace_node(3, 'b'));
+		CHECK(u.is_node("bbb"));
+	}
+}
+
 TEST_CASE("Accessors work as expected") {
 	SECTION("is_node") {
 		auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
@@ -224,6 +383,12 @@ TEST_CASE("Accessors work as expected") {
 		auto it_ne = g.find("A", "A", 3);
 		CHECK((*it)->get_weight() == 3);
 		CHECK(it_ne == g.find("X", "T"));
+		gdwg::graph<std::string, int>::edge owned = *it;
+		CHECK(owned->print_edge() == "B -> D | W | 3");
+		CHECK((*g.find("B", "D"))->print_edge() == "B -> D | U");
+		CHECK(g.find("B", "D") != g.find("X", "T"));
+		CHECK(g.find("B", "D", 4) == g.find("X", "T"));
+		CHECK(g.find("A", "B", 6) == g.find("X", "T"));
 	}
 	SECTION("connections") {
 		auto g = gdwg::graph<std::string, int>{"A", "B", "C", "S"};
@@ -246,6 +411,49 @@ TEST_CASE("Accessors work as expected") {
 	}
 }
 
+TEST_CASE("Views work as expected") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C", "S"};
+	g.insert_edge("A", "S", 1);
+	g.insert_edge("A", "C", 2);
+	g.insert_edge("A", "C", 1);
+	g.insert_edge("A", "C");
+	g.insert_edge("A", "A", 6);
+	SECTION("nodes_view") {
+		auto v = g.nodes_view();
+		CHECK(std::vector<std::string>(v.begin(), v.end()) == g.nodes());
+	}
+	SECTION("connections_view") {
+		static_assert(std::forward_iterator<gdwg::graph<std::string, int>::connection_iterator>);
+		auto v = g.connections_view("A");
+		CHECK(std::vector<std::string>(v.begin(), v.end()) == std::vector<std::string>{"A", "C", "S"});
+		CHECK(g.connections_view("B").empty());
+		try {
+			(void)g.connections_view("T");
+		} catch (const std::runtime_error& e) {
+			CHECK(std::string(e.what())
+			      == "Cannot call gdwg::graph<N, E>::connections_view if src doesn't exist in the graph");
+		} catch (...) {
+			CHECK(false);
+		}
+	}
+	SECTION("edges_view") {
+		auto out = std::vector<std::string>{};
+		for (auto const& e : g.edges_view("A", "C")) {
+			out.push_back(e->print_edge());
+		}
+		CHECK(out == std::vector<std::string>{"A -> C | U", "A -> C | W | 1", "A -> C | W | 2"});
+		CHECK(g.edges_view("C", "A").empty());
+		try {
+			(void)g.edges_view("A", "T");
+		} catch (const std::runtime_error& e) {
+			CHECK(std::string(e.what())
+			      == "Cannot call gdwg::graph<N, E>::edges_view if src or dst node don't exist in the graph");
+		} catch (...) {
+			CHECK(false);
+		}
+	}
+}
+
 TEST_CASE("Comparisons") {
 	SECTION("operator==") {
 		auto g = gdwg::graph<std::string, int>{"A", "C", "S"};
@@ -256,6 +464,50 @@ TEST_CASE("Comparisons") {
 		auto move_assign_g = std::move(g);
 		CHECK(g != move_assign_g);
 	}
+	SECTION("operator== compares values, not insertion order") {
+		auto a = gdwg::graph<std::string, int>{"A", "B", "C"};
+		a.insert_edge("A", "B", 1);
+		a.insert_edge("C", "A");
+		a.insert_edge("A", "B", 2);
+		auto b = gdwg::graph<std::string, int>{"C", "B", "A"};
+		b.insert_edge("A", "B", 2);
+		b.insert_edge("A", "B", 1);
+		b.insert_edge("C", "A");
+		CHECK(a == b);
+		b.erase_edge("A", "B", 2);
+		b.insert_edge("A", "B", 3);
+		CHECK(a != b);
+		b.erase_edge("A", "B", 3);
+		b.insert_edge("A", "C", 2);
+		CHECK(a != b);
+		auto c = gdwg::graph<std::string, int>{"A", "B", "D"};
+		c.insert_edge("A", "B", 1);
+		c.insert_edge("D", "A");
+		c.insert_edge("A", "B", 2);
+		CHECK(a != c);
+	}
+	SECTION("fingerprint") {
+		auto a = gdwg::graph<std::string, int>{"A", "B"};
+		a.insert_edge("A", "B", 1);
+		auto b = gdwg::graph<std::string, int>{"B", "A"};
+		b.insert_edge("A", "B", 1);
+		CHECK(a.fingerprint() == b.fingerprint());
+		CHECK(a == b);
+		// a change forgets the fingerprint, so a stale one never decides a comparison
+		b.insert_edge("B", "A", 1);
+		b.erase_edge("B", "A", 1);
+		CHECK(a == b);
+		b.replace_node("B", "C");
+		CHECK(a.fingerprint() != b.fingerprint());
+		CHECK(a != b);
+		CHECK(b.replace_node("C", "B"));
+		CHECK(a.fingerprint() == b.fingerprint());
+		auto copy = b;
+		CHECK(copy.fingerprint() == b.fingerprint());
+		copy.clear();
+		CHECK(copy.fingerprint() == gdwg::graph<std::string, int>{}.fingerprint());
+		CHECK(copy != b);
+	}
 }
 
 TEST_CASE("Extractor") {
@@ -321,6 +573,11 @@ TEST_CASE("Extractor") {
 )");
 		CHECK(out.str() == expected_output);
 	}
+	SECTION("operator<< on graphs without edges") {
+		auto out = std::ostringstream{};
+		out << gdwg::graph<int, int>{} << gdwg::graph<int, int>{2, 1};
+		CHECK(out.str() == "\n\n1 (\n)\n2 (\n)\n");
+	}
 }
 
 TEST_CASE("Iterator") {
@@ -380,4 +637,900 @@ TEST_CASE("Iterator") {
 21 -> 31 (weight 14)
 )");
 	CHECK(out.str() == expected_output);
-}
\ No newline at end of file
+
+	SECTION("dereferencing refers to the stored edge") {
+		using iterator = decltype(g.begin());
+		static_assert(std::random_access_iterator<iterator>);
+		static_assert(std::ranges::random_access_range<gdwg::graph<int, int>>);
+		auto first = g.begin();
+		CHECK(&(*first).from == &(*std::next(first)).from);
+		CHECK(g.end() - g.begin() == 10);
+		CHECK(g.begin()[3].to == 21);
+		CHECK((g.begin() + 9 == std::prev(g.end()) and g.begin() < g.end()));
+		iterator::value_type copy = *(g.end() - 1);
+		CHECK((copy.from == 21 and copy.to == 31 and copy.weight == 14));
+		auto sorted = std::vector<int>{};
+		std::ranges::transform(g, std::back_inserter(sorted), [](auto const& e) { return e.from; });
+		CHECK(std::ranges::is_sorted(sorted));
+	}
+}
+TEST_CASE("unordered_graph") {
+	SECTION("same behaviour as graph") {
+		auto g = gdwg::unordered_graph<std::string, int>{"C", "A", "B"};
+		g.insert_edge("A", "B", 1);
+		g.insert_edge("C", "A");
+		CHECK(g.is_node("A"));
+		CHECK(not g.is_node("D"));
+		CHECK(g.nodes() == std::vector<std::string>{"A", "B", "C"});
+		CHECK(g.replace_node("A", "D"));
+		CHECK(not g.is_node("A"));
+		CHECK(g.is_connected("D", "B"));
+		CHECK(g.is_connected("C", "D"));
+		auto copy_g = g;
+		CHECK(copy_g == g);
+		CHECK(copy_g.erase_node("D"));
+		CHECK(g.is_node("D"));
+		CHECK(not copy_g.is_node("D"));
+		auto moved_g = std::move(g);
+		CHECK(moved_g.is_node("D"));
+		g.clear();
+		CHECK(not g.is_node("D"));
+		CHECK(g.insert_node("D"));
+	}
+	SECTION("index stays consistent through many inserts and erases") {
+		auto g = gdwg::unordered_graph<int, int>{};
+		for (auto i = 0; i < 1000; ++i) {
+			CHECK(g.insert_node(i * 7));
+		}
+		for (auto i = 0; i < 1000; i += 3) {
+			CHECK(g.erase_node(i * 7));
+		}
+		auto consistent = true;
+		for (auto i = 0; i < 1000; ++i) {
+			consistent = consistent and g.is_node(i * 7) == (i % 3 != 0) and not g.is_node(i * 7 + 1);
+		}
+		CHECK(consistent);
+		CHECK(g.nodes().size() == 666);
+	}
+}
+
+TEST_CASE("Transactions") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
+	g.insert_edge("A", "B", 1);
+	g.insert_edge("B", "C", 2);
+	SECTION("commit matches applying each modification in order") {
+		auto expected = g;
+		expected.insert_node("D");
+		expected.insert_edge("D", "A", 3);
+		expected.insert_edge("A", "D");
+		expected.erase_edge("A", "B", 1);
+		expected.replace_node("C", "E");
+		expected.merge_replace_node("D", "B");
+		expected.insert_edge("B", "B", 4);
+		expected.erase_node("A");
+		expected.insert_node("A");
+		expected.insert_edge("A", "E", 5);
+
+		auto tx = g.batch();
+		tx.insert_node("D").insert_edge("D", "A", 3).insert_edge("A", "D");
+		tx.erase_edge("A", "B", 1);
+		tx.replace_node("C", "E").merge_replace_node("D", "B");
+		tx.insert_edge("B", "B", 4);
+		tx.erase_node("A").insert_node("A").insert_edge("A", "E", 5);
+		CHECK(tx.size() == 10);
+		tx.commit();
+		CHECK(tx.size() == 0);
+		CHECK(g == expected);
+		auto out = std::ostringstream{};
+		auto expected_out = std::ostringstream{};
+		out << g;
+		expected_out << expected;
+		CHECK(out.str() == expected_out.str());
+	}
+	SECTION("merges chain and undo each other") {
+		g.insert_node("D");
+		g.insert_edge("C", "A", 7);
+		auto expected = g;
+		expected.merge_replace_node("A", "D");
+		expected.merge_replace_node("D", "A");
+		expected.merge_replace_node("B", "C");
+		g.batch().merge_replace_node("A", "D").merge_replace_node("D", "A").merge_replace_node("B", "C").commit();
+		CHECK(g == expected);
+	}
+	SECTION("a node merged twice keeps its edges where the first merge put them") {
+		g.insert_node("X");
+		g.insert_edge("A", "X", 6);
+		auto expected = g;
+		expected.merge_replace_node("A", "B");
+		expected.merge_replace_node("A", "C");
+		expected.replace_node("B", "D");
+		expected.merge_replace_node("D", "X");
+		expected.merge_replace_node("D", "A");
+		g.batch()
+		    .merge_replace_node("A", "B")
+		    .merge_replace_node("A", "C")
+		    .replace_node("B", "D")
+		    .merge_replace_node("D", "X")
+		    .merge_replace_node("D", "A")
+		    .commit();
+		CHECK(g == expected);
+		CHECK(g.is_connected("X", "X"));
+		CHECK(not g.is_connected("C", "X"));
+	}
+	SECTION("nothing is applied when a modification would throw") {
+		auto before = g;
+		auto tx = g.batch();
+		tx.insert_node("D").insert_edge("A", "D").erase_node("D").insert_edge("A", "D");
+		try {
+			tx.commit();
+		} catch (const std::runtime_error& e) {
+			CHECK(std::string(e.what())
+			      == "Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist");
+		} catch (...) {
+			CHECK(false);
+		}
+		CHECK(g == before);
+		CHECK(not g.is_node("D"));
+		tx.discard();
+		CHECK(tx.size() == 0);
+	}
+}
+
+TEMPLATE_TEST_CASE("Copies share their storage until one is modified",
+                   "",
+                   (gdwg::graph<std::string, int>),
+                   (gdwg::unordered_graph<std::string, int>),
+                   (gdwg::bidirectional_graph<std::string, int>)) {
+	auto g = TestType{"A", "B", "C"};
+	g.insert_edge("A", "B", 1);
+	g.insert_edge("A", "B", 2);
+	g.insert_edge("B", "C", 3);
+	auto copy = g;
+	CHECK(copy.find_node("A") == g.find_node("A"));
+	CHECK(copy == g);
+	auto original = std::vector<std::string>{"A", "B", "C"};
+
+	SECTION("replace_node on the copy leaves the original alone") {
+		CHECK(copy.replace_node("B", "D"));
+		CHECK(copy.find_node("A") != g.find_node("A"));
+		CHECK(copy.is_connected("A", "D"));
+		CHECK(g.nodes() == original);
+		CHECK(g.is_connected("A", "B"));
+		CHECK(g.in_connections("B") == std::vector<std::string>{"A"});
+		CHECK(copy.in_connections("D") == std::vector<std::string>{"A"});
+	}
+	SECTION("modifying the original leaves the copy alone") {
+		g.merge_replace_node("A", "C");
+		CHECK(g.erase_node("B"));
+		CHECK(copy.nodes() == original);
+		CHECK(copy.edges("A", "B").size() == 2);
+		CHECK(copy.in_connections("C") == std::vector<std::string>{"B"});
+	}
+	SECTION("calls that change nothing or throw leave the storage shared") {
+		CHECK(not copy.insert_node("A"));
+		CHECK(not copy.emplace_node("B"));
+		CHECK(not copy.insert_edge("A", "B", 1));
+		CHECK(not copy.replace_node("A", "C"));
+		CHECK(not copy.erase_node("D"));
+		CHECK_THROWS(copy.insert_edge("A", "D", 1));
+		CHECK_THROWS(copy.replace_node("D", "E"));
+		CHECK_THROWS(copy.merge_replace_node("A", "D"));
+		auto missing = std::vector<std::tuple<std::string, std::string, int>>{{"A", "C", 5}, {"D", "A", 6}};
+		CHECK_THROWS(copy.insert_edges(missing.begin(), missing.end()));
+		CHECK_THROWS(copy.insert_edges(std::execution::par, missing.begin(), missing.end()));
+		CHECK(copy.find_node("A") == g.find_node("A"));
+	}
+	SECTION("edges resolved against the shared storage end up in the copy") {
+		auto batch = std::vector<std::tuple<std::string, std::string, int>>{{"C", "A", 5}, {"A", "B", 1}};
+		CHECK(copy.insert_edges(batch.begin(), batch.end()) == 1);
+		CHECK(copy.find_node("A") != g.find_node("A"));
+		CHECK(copy.is_connected("C", "A"));
+		CHECK(not g.is_connected("C", "A"));
+		auto again = g;
+		CHECK(again.insert_edges(std::execution::par, batch.begin(), batch.end()) == 1);
+		CHECK(again == copy);
+		CHECK(again.erase_node("C"));
+		CHECK(again.nodes() == std::vector<std::string>{"A", "B"});
+		CHECK(g.nodes() == original);
+		CHECK(again.emplace_node("E"));
+		CHECK(not g.is_node("E"));
+	}
+	SECTION("erase_edge with iterators into the shared storage") {
+		auto it = copy.find("A", "B", 1);
+		auto next = copy.erase_edge(it);
+		CHECK((*next).weight() == 2);
+		CHECK(copy.edges("A", "B").size() == 1);
+		CHECK(g.edges("A", "B").size() == 2);
+		auto again = g;
+		auto range = again.edges_view("A", "B");
+		auto last = again.erase_edge(range.begin(), range.end());
+		CHECK((*last).src() == "B");
+		CHECK(not again.is_connected("A", "B"));
+		CHECK(g.is_connected("A", "B"));
+	}
+	SECTION("clear and transactions") {
+		copy.clear();
+		CHECK(copy.empty());
+		CHECK(g.nodes() == original);
+		auto batched = g;
+		batched.batch().erase_node("A").insert_node("E").insert_edge("E", "C", 4).commit();
+		CHECK(batched.is_connected("E", "C"));
+		CHECK(g.nodes() == original);
+		CHECK(not g.is_node("E"));
+	}
+	SECTION("assignment shares as well") {
+		auto other = TestType{"X"};
+		other = g;
+		CHECK(other.find_node("B") == g.find_node("B"));
+		other.insert_node("X");
+		CHECK(g.nodes() == original);
+		auto moved = std::move(other);
+		CHECK(other.empty());
+		other.insert_node("Y");
+		CHECK(other.nodes() == std::vector<std::string>{"Y"});
+		CHECK(moved.is_node("X"));
+	}
+}
+
+TEST_CASE("Diff and apply") {
+	using delta = gdwg::graph_delta<std::string, int>;
+	auto from = gdwg::graph<std::string, int>{"A", "B", "C", "D"};
+	from.insert_edge("A", "B", 1);
+	from.insert_edge("A", "B", 2);
+	from.insert_edge("B", "C");
+	from.insert_edge("D", "A", 4);
+	auto to = gdwg::graph<std::string, int>{"A", "B", "C", "E"};
+	to.insert_edge("A", "B", 2);
+	to.insert_edge("A", "B", 3);
+	to.insert_edge("B", "C");
+	to.insert_edge("E", "A");
+
+	SECTION("diff") {
+		auto d = gdwg::diff(from, to);
+		CHECK(d.added_nodes == std::vector<std::string>{"E"});
+		CHECK(d.removed_nodes == std::vector<std::string>{"D"});
+		CHECK(d.added_edges == std::vector<delta::edge_type>{{"A", "B", 3}, {"E", "A", std::nullopt}});
+		// D -> A goes with D
+		CHECK(d.removed_edges == std::vector<delta::edge_type>{{"A", "B", 1}});
+		CHECK(gdwg::diff(to, to).empty());
+		CHECK(gdwg::diff(from, gdwg::graph<std::string, int>{}).removed_nodes.size() == 4);
+	}
+	SECTION("apply") {
+		from.apply(gdwg::diff(from, to));
+		CHECK(from == to);
+		auto empty = gdwg::graph<std::string, int>{};
+		empty.apply(gdwg::diff(empty, to));
+		CHECK(empty == to);
+		empty.apply(gdwg::diff(to, gdwg::graph<std::string, int>{}));
+		CHECK(empty.empty());
+	}
+	SECTION("a delta that doesn't fit changes nothing") {
+		auto d = delta{};
+		d.added_nodes = {"F"};
+		d.added_edges = {{"F", "X", 1}};
+		CHECK_THROWS_WITH(from.apply(d),
+		                  "Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist");
+		CHECK_FALSE(from.is_node("F"));
+	}
+	SECTION("round trips between random graphs") {
+		auto state = 1234U;
+		auto roll = [&state](unsigned bound) {
+			state = state * 1103515245U + 12345U;
+			return static_cast<int>((state >> 16) % bound);
+		};
+		auto random_graph = [&] {
+			auto g = gdwg::bidirectional_graph<int, int>{};
+			for (auto i = 0; i < 30; ++i) {
+				if (roll(4) != 0) {
+					g.insert_node(i);
+				}
+			}
+			auto nodes = g.nodes();
+			for (auto i = 0; i < 120; ++i) {
+				auto const& src = nodes[static_cast<std::size_t>(roll(static_cast<unsigned>(nodes.size())))];
+				auto const& dst = nodes[static_cast<std::size_t>(roll(static_cast<unsigned>(nodes.size())))];
+				g.insert_edge(src, dst, roll(3));
+			}
+			return g;
+		};
+		for (auto round = 0; round < 20; ++round) {
+			auto a = random_graph();
+			auto b = random_graph();
+			auto copy = a;
+			copy.apply(gdwg::diff(a, b));
+			CHECK(copy == b);
+			CHECK(copy.in_connections(copy.nodes().front()) == b.in_connections(b.nodes().front()));
+		}
+	}
+}
+
+TEST_CASE("Parallel construction") {
+	auto nodes = std::vector<int>{};
+	auto edges = std::vector<std::tuple<int, int, std::optional<int>>>{};
+	for (auto i = 0; i < 2000; ++i) {
+		nodes.push_back((i * 7919) % 500);
+		edges.emplace_back((i * 31) % 500, (i * 17) % 500, i % 3 == 0 ? std::nullopt : std::optional<int>{i % 5});
+	}
+	auto const expected = gdwg::graph<int, int>(nodes.begin(), nodes.end(), edges.begin(), edges.end());
+
+	SECTION("nodes and edges under a parallel policy") {
+		auto g = gdwg::graph<int, int>(std::execution::par, nodes.begin(), nodes.end(), edges.begin(), edges.end());
+		CHECK(g == expected);
+		CHECK(std::ranges::equal(g, expected, [](auto const& a, auto const& b) {
+			return a.from == b.from and a.to == b.to and a.weight == b.weight;
+		}));
+	}
+	SECTION("nodes only") {
+		auto g = gdwg::graph<int, int>(std::execution::par_unseq, nodes.begin(), nodes.end());
+		CHECK(g.nodes() == expected.nodes());
+		CHECK(g.begin() == g.end());
+	}
+	SECTION("nodes already sorted and unique") {
+		auto sorted = expected.nodes();
+		auto g = gdwg::unordered_graph<int, int>(gdwg::sorted_unique, sorted.begin(), sorted.end());
+		CHECK(g.nodes() == sorted);
+		CHECK(g.is_node(sorted.back()));
+	}
+	SECTION("insert_edges under a policy merges with the edges already there") {
+		auto g = gdwg::graph<int, int>(nodes.begin(), nodes.end());
+		auto half = edges.begin() + 1000;
+		auto added = g.insert_edges(edges.begin(), half);
+		added += g.insert_edges(std::execution::par, edges.begin(), edges.end());
+		CHECK(g == expected);
+		CHECK(added == static_cast<std::size_t>(std::distance(expected.begin(), expected.end())));
+	}
+	SECTION("missing nodes are reported after the parallel lookup") {
+		auto g = gdwg::graph<int, int>(std::execution::par, nodes.begin(), nodes.end());
+		auto bad = std::vector<std::tuple<int, int, int>>{{1, 2, 3}, {1, 501, 3}};
+		try {
+			g.insert_edges(std::execution::par, bad.begin(), bad.end());
+			FAIL("insert_edges should have thrown");
+		} catch (std::runtime_error const& e) {
+			CHECK(std::string{e.what()}
+			      == "Cannot call gdwg::graph<N, E>::insert_edges when either src or dst node does not exist");
+		}
+		CHECK_FALSE(g.is_connected(1, 2));
+	}
+}
+
+TEST_CASE("Graphs without weights") {
+	auto g = gdwg::graph<std::string, void>{"A", "B", "C"};
+	CHECK(g.insert_edge("A", "B"));
+	CHECK_FALSE(g.insert_edge("A", "B"));
+	CHECK(g.insert_edge("B", "C"));
+	CHECK(g.insert_edge("C", "C"));
+
+	SECTION("edges have no weight") {
+		auto edges = g.edges("A", "B");
+		REQUIRE(edges.size() == 1);
+		CHECK_FALSE(edges.front()->is_weighted());
+		CHECK(edges.front()->print_edge() == "A -> B | U");
+		CHECK_FALSE((*g.begin()).weight.has_value());
+	}
+	SECTION("modifiers") {
+		CHECK(g.replace_node("A", "D"));
+		CHECK(g.is_connected("D", "B"));
+		CHECK(g.erase_edge("D", "B"));
+		CHECK_FALSE(g.is_connected("D", "B"));
+		auto pairs = std::vector<std::pair<std::string, std::string>>{{"B", "A"}, {"B", "C"}, {"A", "C"}};
+		g.insert_node("A");
+		CHECK(g.insert_edges(pairs.begin(), pairs.end()) == 2);
+		CHECK(g.connections("B") == std::vector<std::string>{"A", "C"});
+	}
+	SECTION("diff, apply and transactions") {
+		auto other = gdwg::graph<std::string, void>{"A", "C"};
+		other.insert_edge("C", "A");
+		auto copy = g;
+		copy.apply(gdwg::diff(g, other));
+		CHECK(copy == other);
+		CHECK(copy.fingerprint() == other.fingerprint());
+		g.batch().erase_node("B").insert_edge("C", "A").commit();
+		CHECK(g.connections("C") == std::vector<std::string>{"A", "C"});
+	}
+	SECTION("sorting many edges at once matches inserting them one by one") {
+		auto state = 99U;
+		auto roll = [&state] {
+			state = state * 1103515245U + 12345U;
+			return static_cast<long>((state >> 8) % 2001) - 1000;
+		};
+		auto nodes = std::vector<long>{};
+		for (auto i = -1000L; i <= 1000; ++i) {
+			nodes.push_back(i);
+		}
+		auto pairs = std::vector<std::pair<long, long>>{};
+		auto triples = std::vector<std::tuple<long, long, std::optional<int>>>{};
+		auto one_by_one = gdwg::graph<long, void>(nodes.begin(), nodes.end());
+		auto weighted_one_by_one = gdwg::graph<long, int>(nodes.begin(), nodes.end());
+		for (auto i = 0; i < 5000; ++i) {
+			auto src = roll();
+			auto dst = roll() % 50;
+			auto weight = src % 7 == 0 ? std::nullopt : std::optional<int>{static_cast<int>(roll() % 300)};
+			pairs.emplace_back(src, dst);
+			triples.emplace_back(src, dst, weight);
+			one_by_one.insert_edge(src, dst);
+			weighted_one_by_one.insert_edge(src, dst, weight);
+		}
+		auto bulk = gdwg::graph<long, void>(nodes.begin(), nodes.end());
+		CHECK(bulk.insert_edges(pairs.begin(), pairs.end())
+		      == static_cast<std::size_t>(std::distance(one_by_one.begin(), one_by_one.end())));
+		CHECK(bulk == one_by_one);
+		auto weighted_bulk = gdwg::graph<long, int>(nodes.begin(), nodes.end());
+		(void)weighted_bulk.insert_edges(triples.begin(), triples.end());
+		CHECK(weighted_bulk == weighted_one_by_one);
+		CHECK(std::ranges::equal(weighted_bulk, weighted_one_by_one, [](auto const& a, auto const& b) {
+			return a.from == b.from and a.to == b.to and a.weight == b.weight;
+		}));
+	}
+}
+
+TEST_CASE("Reverse edge index") {
+	auto g = gdwg::bidirectional_graph<std::string, int>{"A", "B", "C", "D"};
+	g.insert_edge("A", "C", 1);
+	g.insert_edge("A", "C", 2);
+	g.insert_edge("B", "C");
+	g.insert_edge("C", "C", 3);
+	g.insert_edge("C", "A", 4);
+
+	SECTION("in_connections and in_edges") {
+		CHECK(g.in_connections("C") == std::vector<std::string>{"A", "B", "C"});
+		CHECK(g.in_connections("D").empty());
+		auto in = g.in_edges("C");
+		REQUIRE(in.size() == 4);
+		CHECK(in[0]->print_edge() == "A -> C | W | 1");
+		CHECK(in[1]->print_edge() == "A -> C | W | 2");
+		CHECK(in[2]->print_edge() == "B -> C | U");
+		CHECK(in[3]->print_edge() == "C -> C | W | 3");
+		try {
+			(void)g.in_edges("X");
+			FAIL("in_edges should have thrown");
+		} catch (std::runtime_error const& e) {
+			CHECK(std::string{e.what()} == "Cannot call gdwg::graph<N, E>::in_edges if dst doesn't exist in the graph");
+		}
+	}
+	SECTION("the index follows the modifiers") {
+		g.replace_node("C", "0");
+		CHECK(g.in_connections("0") == std::vector<std::string>{"0", "A", "B"});
+		CHECK(g.connections("A") == std::vector<std::string>{"0"});
+		g.merge_replace_node("B", "A");
+		CHECK(g.in_connections("0") == std::vector<std::string>{"0", "A"});
+		g.erase_edge("0", "0", 3);
+		g.erase_node("A");
+		CHECK(g.in_connections("0").empty());
+		CHECK(g.in_edges("0").empty());
+		CHECK(g.nodes() == std::vector<std::string>{"0", "B", "D"});
+	}
+	SECTION("erasing a hub without edges of its own leaves the rest in order") {
+		// node 0 has no out edges, so its empty block starts where the block of 1 does
+		auto hub = gdwg::bidirectional_graph<int, int>{0, 17};
+		for (auto i = 1; i <= 16; ++i) {
+			hub.insert_node(i);
+			hub.insert_edge(i, 0, i);
+			hub.insert_edge(i, 17, i);
+		}
+		CHECK(hub.erase_node(0));
+		CHECK(std::distance(hub.begin(), hub.end()) == 16);
+		CHECK(hub.in_connections(17).size() == 16);
+		for (auto i = 1; i <= 16; ++i) {
+			CHECK(hub.connections(i) == std::vector<int>{17});
+		}
+	}
+	SECTION("copies have their own index") {
+		auto copy = g;
+		g.clear();
+		CHECK(copy.in_connections("C") == std::vector<std::string>{"A", "B", "C"});
+		CHECK(copy.in_connections("A") == std::vector<std::string>{"C"});
+	}
+	SECTION("without the index the same answers come from a scan") {
+		auto plain = gdwg::graph<std::string, int>{"A", "B", "C"};
+		plain.insert_edge("B", "C");
+		plain.insert_edge("A", "C", 1);
+		CHECK(plain.in_connections("C") == std::vector<std::string>{"A", "B"});
+		CHECK(plain.in_edges("C").size() == 2);
+	}
+}
+
+TEST_CASE("Reverse edge index agrees with the edges") {
+	auto g = gdwg::bidirectional_graph<int, int>{};
+	auto plain = gdwg::graph<int, int>{};
+	auto state = 6771U;
+	auto roll = [&state](unsigned bound) {
+		state = state * 1103515245U + 12345U;
+		return static_cast<int>((state >> 16) % bound);
+	};
+	for (auto i = 0; i < 40; ++i) {
+		g.insert_node(i);
+		plain.insert_node(i);
+	}
+	for (auto step = 0; step < 3000; ++step) {
+		auto a = roll(40);
+		auto b = roll(40);
+		auto w = roll(3);
+		switch (roll(10)) {
+		case 0:
+			if (g.is_node(a) and not g.is_node(b + 40)) {
+				CHECK(g.replace_node(a, b + 40) == plain.replace_node(a, b + 40));
+			}
+			break;
+		case 1:
+			if (g.is_node(a) and g.is_node(b)) {
+				g.merge_replace_node(a, b);
+				plain.merge_replace_node(a, b);
+			}
+			break;
+		case 2: CHECK(g.erase_node(a) == plain.erase_node(a)); break;
+		case 3:
+			if (g.is_node(a) and g.is_node(b)) {
+				CHECK(g.erase_edge(a, b, w) == plain.erase_edge(a, b, w));
+			}
+			break;
+		case 4:
+			if (g.is_node(a) and g.is_node(b)) {
+				g.batch().insert_node(a + 200).insert_edge(a, a + 200, w).merge_replace_node(a + 200, b).commit();
+				plain.batch().insert_node(a + 200).insert_edge(a, a + 200, w).merge_replace_node(a + 200, b).commit();
+			}
+			break;
+		case 5:
+			if (auto c = roll(40); g.is_node(a) and g.is_node(b) and g.is_node(c)) {
+				g.batch().merge_replace_node(a, b).merge_replace_node(a, c).merge_replace_node(b, a).commit();
+				plain.merge_replace_node(a, b);
+				plain.merge_replace_node(a, c);
+				plain.merge_replace_node(b, a);
+			}
+			break;
+		default:
+			CHECK(g.insert_node(a) == plain.insert_node(a));
+			CHECK(g.insert_node(b) == plain.insert_node(b));
+			CHECK(g.insert_edge(a, b, w) == plain.insert_edge(a, b, w));
+		}
+	}
+	auto mismatches = 0;
+	for (auto const& n : g.nodes()) {
+		if (g.in_connections(n) != plain.in_connections(n) or g.connections(n) != plain.connections(n)) {
+			++mismatches;
+		}
+		auto in = g.in_edges(n);
+		auto expected = plain.in_edges(n);
+		if (in.size() != expected.size()
+		    or not std::equal(in.begin(), in.end(), expected.begin(), [](auto const& x, auto const& y) {
+			       return x->print_edge() == y->print_edge();
+		       }))
+		{
+			++mismatches;
+		}
+	}
+	CHECK(mismatches == 0);
+	CHECK(g.nodes() == plain.nodes());
+	CHECK(std::ranges::equal(g, plain, [](auto const& x, auto const& y) {
+		return x.from == y.from and x.to == y.to and x.weight == y.weight;
+	}));
+}
+
+namespace {
+	// forwards to the heap and keeps count of the bytes asked for
+	class counting_resource : public std::pmr::memory_resource {
+	 public:
+		std::size_t allocated = 0;
+
+	 private:
+		auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+			allocated += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+
+		auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+			return this == &other;
+		}
+	};
+
+	// forwards to the heap until budget allocations have been made, then throws std::bad_alloc
+	class failing_resource : public std::pmr::memory_resource {
+	 public:
+		std::size_t budget = std::numeric_limits<std::size_t>::max();
+
+	 private:
+		auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+			if (budget == 0) {
+				throw std::bad_alloc{};
+			}
+			--budget;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+
+		auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+			return this == &other;
+		}
+	};
+
+	// anything that falls back on the default resource while this is alive throws std::bad_alloc
+	struct no_default_resource {
+		std::pmr::memory_resource* old = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+		no_default_resource() = default;
+		no_default_resource(no_default_resource const&) = delete;
+		auto operator=(no_default_resource const&) -> no_default_resource& = delete;
+		~no_default_resource() {
+			std::pmr::set_default_resource(old);
+		}
+	};
+} // namespace
+
+TEMPLATE_TEST_CASE("Memory resources",
+                   "",
+                   (gdwg::graph<int, int>),
+                   (gdwg::unordered_graph<int, int>),
+                   (gdwg::bidirectional_graph<int, int>)) {
+	auto arena = std::pmr::monotonic_buffer_resource{};
+	auto plain = TestType{1, 2, 3, 4};
+	plain.insert_edge(1, 2, 5);
+	plain.insert_edge(2, 3);
+	plain.insert_edge(4, 1, 6);
+
+	SECTION("a graph allocates from its resource only") {
+		auto guard = no_default_resource{};
+		auto g = TestType({1, 2, 3, 4}, &arena);
+		CHECK(g.get_allocator().resource() == &arena);
+		g.insert_edge(1, 2, 5);
+		g.insert_edge(2, 3);
+		g.insert_edge(4, 1, 6);
+		g.insert_edge(3, 3, 1);
+		CHECK(g.replace_node(3, 7));
+		CHECK(g.erase_edge(7, 7, 1));
+		CHECK(g.replace_node(7, 3));
+		CHECK(g == plain);
+		auto copy = TestType(g, &arena);
+		CHECK(copy.get_allocator() == g.get_allocator());
+		CHECK(copy == plain);
+		g.clear();
+		CHECK(g.empty());
+	}
+	SECTION("a copy allocates from the default resource unless told otherwise") {
+		auto g = TestType(plain, &arena);
+		auto copy = g;
+		CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+		CHECK(copy == plain);
+		copy = plain;
+		CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+		g = copy;
+		CHECK(g.get_allocator().resource() == &arena);
+		CHECK(g == plain);
+	}
+	SECTION("moving between resources copies into the resource of the target") {
+		auto g = TestType(&arena);
+		g = std::move(plain);
+		CHECK(g.get_allocator().resource() == &arena);
+		CHECK(g.is_connected(4, 1));
+		auto moved = TestType(std::move(g), &arena);
+		CHECK(moved.get_allocator().resource() == &arena);
+		CHECK(moved.is_connected(4, 1));
+	}
+	SECTION("containers pass their resource on to the graphs they hold") {
+		auto graphs = std::pmr::vector<TestType>(&arena);
+		graphs.push_back(plain);
+		graphs.emplace_back(std::initializer_list<int>{1, 2});
+		graphs.emplace_back();
+		for (auto const& g : graphs) {
+			CHECK(g.get_allocator().resource() == &arena);
+		}
+		CHECK(graphs[0] == plain);
+		CHECK(graphs[1].nodes() == std::vector<int>{1, 2});
+	}
+	SECTION("clear keeps the storage for the next nodes and edges") {
+		auto counter = counting_resource{};
+		auto g = TestType(&counter);
+		auto fill = [&g] {
+			for (auto i = 0; i < 100; ++i) {
+				g.insert_node(i);
+			}
+			for (auto i = 0; i < 100; ++i) {
+				g.insert_edge(i, (i * 7) % 100, i);
+			}
+		};
+		fill();
+		auto first = std::exchange(counter.allocated, 0);
+		g.clear();
+		fill();
+		CHECK(counter.allocated < first);
+	}
+}
+
+TEST_CASE("Instrumentation") {
+	using gdwg::graph_op;
+	auto g = gdwg::instrumented_graph<int, int>{};
+	for (auto i = 1; i <= 4; ++i) {
+		g.insert_node(i);
+	}
+	SECTION("graphs without instrumentation pay nothing for it") {
+		STATIC_REQUIRE(sizeof(gdwg::graph<int, int>) < sizeof(g));
+		STATIC_REQUIRE(not gdwg::no_instrumentation::enabled);
+	}
+	SECTION("every call is counted under its operation") {
+		g.insert_edge(1, 2, 5);
+		g.insert_edge(1, 3, 5);
+		(void)g.is_connected(1, 2);
+		(void)g.is_connected(2, 1);
+		(void)g.connections(1);
+		auto const stats = g.stats();
+		CHECK(stats[graph_op::insert_node].calls == 4);
+		CHECK(stats[graph_op::insert_edge].calls == 2);
+		CHECK(stats[graph_op::is_connected].calls == 2);
+		CHECK(stats[graph_op::connections].calls == 1);
+		CHECK(stats[graph_op::erase_node].calls == 0);
+		CHECK(stats[graph_op::insert_edge].allocations > 0);
+		auto const& latency = stats[graph_op::is_connected].latency;
+		CHECK(std::accumulate(latency.begin(), latency.end(), std::uint64_t{0}) == 2);
+		CHECK(gdwg::to_string(graph_op::merge_replace_node) == "merge_replace_node");
+	}
+	SECTION("only the outermost operation is counted") {
+		g.apply(gdwg::graph_delta<int, int>{{5}, {}, {{1, 5, 1}, {2, 5, 1}}, {}});
+		g.erase_edge(1, 5, 1);
+		auto const stats = g.stats();
+		CHECK(stats[graph_op::apply].calls == 1);
+		CHECK(stats[graph_op::commit].calls == 0);
+		CHECK(stats[graph_op::erase_edge].calls == 1);
+		CHECK(stats[graph_op::find].calls == 0);
+		CHECK(stats[graph_op::apply].sorts == 1);
+	}
+	SECTION("bulk inserts and scans are charged for the edges they look at") {
+		auto edges = std::vector<std::tuple<int, int, int>>{{1, 2, 1}, {3, 4, 1}, {2, 1, 1}};
+		CHECK(g.insert_edges(edges.begin(), edges.end()) == 3);
+		(void)g.in_degree(1);
+		auto const stats = g.stats();
+		CHECK(stats[graph_op::insert_edges].sorts == 1);
+		CHECK(stats[graph_op::insert_edges].edges_scanned >= 3);
+		CHECK(stats[graph_op::in_degree].edges_scanned == 3);
+	}
+	SECTION("the callback sees every sample") {
+		auto samples = std::vector<gdwg::op_sample>{};
+		g.instrumentation().on_operation([&samples](gdwg::op_sample const& s) { samples.push_back(s); });
+		g.insert_edge(1, 2, 1);
+		CHECK(g.erase_node(1));
+		CHECK_THROWS(g.is_connected(9, 1));
+		REQUIRE(samples.size() == 3);
+		CHECK(samples[0].op == graph_op::insert_edge);
+		CHECK(samples[1].op == graph_op::erase_node);
+		CHECK(samples[1].edges_scanned == 1);
+		CHECK(samples[2].op == graph_op::is_connected);
+	}
+	SECTION("a copy starts from the totals of the original, reset clears them") {
+		auto copy = g;
+		CHECK(copy.stats()[graph_op::insert_node].calls == 4);
+		copy.instrumentation().reset();
+		CHECK(copy.stats()[graph_op::insert_node].calls == 0);
+		CHECK(g.stats()[graph_op::insert_node].calls == 4);
+	}
+	SECTION("a move takes the totals and the callback, whether constructed or assigned") {
+		auto calls = 0;
+		g.instrumentation().on_operation([&calls](gdwg::op_sample const&) { ++calls; });
+		auto moved = std::move(g);
+		CHECK(moved.stats()[graph_op::insert_node].calls == 4);
+		CHECK(g.stats()[graph_op::insert_node].calls == 0);
+		g.insert_node(5);
+		CHECK(calls == 0);
+		auto assigned = gdwg::instrumented_graph<int, int>{};
+		assigned.insert_node(1);
+		assigned = std::move(moved);
+		CHECK(assigned.stats()[graph_op::insert_node].calls == 4);
+		CHECK(moved.stats()[graph_op::insert_node].calls == 0);
+		assigned.insert_node(6);
+		CHECK(calls == 1);
+		STATIC_REQUIRE(std::is_nothrow_move_constructible_v<gdwg::counting_instrumentation>);
+		STATIC_REQUIRE(std::is_nothrow_move_assignable_v<gdwg::counting_instrumentation>);
+	}
+}
+
+namespace {
+	// a node whose assignment throws while fail is set
+	struct fragile_node {
+		static inline bool fail = false;
+		int value = 0;
+
+		fragile_node(int v)
+		: value{v} {}
+		fragile_node(fragile_node const&) = default;
+		fragile_node(fragile_node&&) = default;
+		~fragile_node() = default;
+
+		auto operator=(fragile_node const& other) -> fragile_node& {
+			if (fail) {
+				throw std::runtime_error{"assignment failed"};
+			}
+			value = other.value;
+			return *this;
+		}
+
+		auto operator=(fragile_node&& other) -> fragile_node& {
+			return *this = other;
+		}
+
+		friend auto operator<=>(fragile_node const&, fragile_node const&) = default;
+
+		friend auto operator<<(std::ostream& os, fragile_node const& n) -> std::ostream& {
+			return os << n.value;
+		}
+	};
+} // namespace
+
+TEMPLATE_TEST_CASE("replace_node leaves the graph as it was when the new value can't be assigned",
+                   "",
+                   (gdwg::graph<fragile_node, int>),
+                   (gdwg::bidirectional_graph<fragile_node, int>)) {
+	auto g = TestType{1, 2, 3};
+	g.insert_edge(1, 2, 4);
+	g.insert_edge(2, 1, 5);
+	g.insert_edge(3, 1, 6);
+	auto const before = g;
+	fragile_node::fail = true;
+	CHECK_THROWS_WITH(g.replace_node(1, 0), "assignment failed");
+	fragile_node::fail = false;
+	CHECK(g.is_node(1));
+	CHECK(not g.is_node(0));
+	CHECK(g == before);
+	CHECK(g.connections(3) == std::vector<fragile_node>{1});
+	CHECK(g.replace_node(1, 0));
+	CHECK(g.connections(3) == std::vector<fragile_node>{0});
+}
+
+TEST_CASE("Reverse edge index survives failed allocations") {
+	auto resource = failing_resource{};
+	auto g = gdwg::bidirectional_graph<int, int>(&resource);
+	for (auto i = 0; i < 8; ++i) {
+		g.insert_node(i);
+	}
+	// every edge into n, once from the edges and once from the index
+	auto agrees = [&g](int n) {
+		auto into = std::count_if(g.begin(), g.end(), [n](auto const& e) { return e.to == n; });
+		return static_cast<std::size_t>(into) == g.in_edges(n).size() and g.in_degree(n) == g.in_edges(n).size();
+	};
+	auto fail_until_done = [&resource, &agrees](auto insert) {
+		for (auto budget = std::size_t{0};; ++budget) {
+			resource.budget = budget;
+			try {
+				insert();
+				resource.budget = std::numeric_limits<std::size_t>::max();
+				return;
+			} catch (std::bad_alloc const&) {
+				resource.budget = std::numeric_limits<std::size_t>::max();
+				for (auto n = 0; n < 8; ++n) {
+					REQUIRE(agrees(n));
+				}
+			}
+		}
+	};
+	for (auto w = 0; w < 20; ++w) {
+		auto inserted = false;
+		fail_until_done([&] { inserted = g.insert_edge(w % 8, (w * 3) % 8, w); });
+		CHECK(inserted);
+	}
+	auto batch = std::vector<std::tuple<int, int, int>>{};
+	for (auto w = 0; w < 300; ++w) {
+		batch.emplace_back(w % 8, (w * 5) % 8, w);
+	}
+	// the edges with w a multiple of 4 are already there
+	auto added = std::size_t{0};
+	fail_until_done([&] { added = g.insert_edges(batch.begin(), batch.end()); });
+	CHECK(added == 295);
+	for (auto n = 0; n < 8; ++n) {
+		CHECK(agrees(n));
+	}
+}
+
+TEST_CASE("Copying shared storage reports a failed allocation") {
+	auto resource = failing_resource{};
+	auto g = gdwg::graph<int, int>(&resource);
+	g.insert_node(1);
+	auto copy = gdwg::graph<int, int>(g, &resource);
+	resource.budget = 0;
+	CHECK_THROWS_AS(copy.insert_node(2), std::bad_alloc);
+	CHECK_THROWS_AS(copy.emplace_node(2), std::bad_alloc);
+	resource.budget = std::numeric_limits<std::size_t>::max();
+	CHECK(copy.find_node(1) == g.find_node(1));
+	CHECK(copy.insert_node(2));
+	CHECK(g.nodes() == std::vector<int>{1});
+}
@@ -0,0 +1,617 @@
+#ifndef GDWG_IO_H
+#	define GDWG_IO_H
+
+#	include "gdwg_csr.h"
+#	include "gdwg_graph.h"
+#	include "gdwg_parallel.h"
+
+#	include <algorithm>
+#	include <array>
+#	include <charconv>
+#	include <cstddef>
+#	include <cstdint>
+#	include <cstring>
+#	include <istream>
+#	include <iterator>
+#	include <limits>
+#	include <memory>
+#	include <optional>
+#	include <ostream>
+#	include <span>
+#	include <stdexcept>
+#	include <string>
+#	include <string_view>
+#	include <tuple>
+#	include <type_traits>
+#	include <utility>
+#	include <vector>
+
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+
+// Versioned binary format for graphs, laid out as the arrays of a csr_graph so that a file can be
+// served straight from memory:
+//
+//   header | nodes | offsets (u64 x V + 1) | dsts (u32 x E) | weights
+//
+// Every section starts on a 16 byte boundary. Trivially copyable nodes and weights are stored as raw
+// arrays in the host's layout, and the header records their sizes and the byte order so a file from
+// an incompatible build is rejected rather than misread. std::string nodes are a string table (u64 x
+// count + 1 offsets followed by the characters). Weights are a u8 x E presence array followed by the
+// values of the weights that are present, as a raw array or a string table.
+//
+// Graphs can also be read back from text, either what graph's operator<< writes or a tab separated
+// edge list, see parse_text.
+namespace gdwg {
+	namespace detail {
+		inline constexpr auto file_magic = std::array<char, 4>{'G', 'D', 'W', 'G'};
+		inline constexpr auto file_version = std::uint32_t{2};
+		inline constexpr auto file_byte_order = std::uint32_t{0x01020304};
+		inline constexpr auto file_alignment = std::size_t{16};
+
+		struct file_header {
+			std::array<char, 4> magic;
+			std::uint32_t version;
+			std::uint32_t byte_order;
+			std::uint32_t node_size; // sizeof(N), 0 for a string table
+			std::uint32_t weight_size; // sizeof(E), 0 for a string table
+			std::uint32_t reserved;
+			std::uint64_t num_nodes;
+			std::uint64_t num_edges;
+		};
+
+		template<typename T>
+		inline constexpr bool is_string_v = std::is_same_v<T, std::string>;
+
+		template<typename T>
+		inline constexpr bool is_packed_v = std::is_trivially_copyable_v<T> and not is_string_v<T>;
+
+		template<typename N, typename E>
+		constexpr auto make_header(std::uint64_t num_nodes, std::uint64_t num_edges) -> file_header {
+			auto node_size = is_packed_v<N> ? sizeof(N) : 0;
+			auto weight_size = is_packed_v<E> ? sizeof(E) : 0;
+			return file_header{file_magic,
+			                   file_version,
+			                   file_byte_order,
+			                   static_cast<std::uint32_t>(node_size),
+			                   static_cast<std::uint32_t>(weight_size),
+			                   0,
+			                   num_nodes,
+			                   num_edges};
+		}
+
+		class byte_writer {
+		 public:
+			explicit byte_writer(std::ostream& os)
+			: os_(os) {}
+
+			template<typename T>
+			void write(std::span<T const> values) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				os_.write(reinterpret_cast<char const*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+				pos_ += values.size_bytes();
+				static auto const padding = std::array<char, file_alignment>{};
+				auto pad = (file_alignment - pos_ % file_alignment) % file_alignment;
+				os_.write(padding.data(), static_cast<std::streamsize>(pad));
+				pos_ += pad;
+			}
+
+			template<typename Range>
+			void write_strings(Range const& strings) {
+				auto offsets = std::vector<std::uint64_t>{0};
+				auto chars = std::string{};
+				for (auto const& str : strings) {
+					chars += str;
+					offsets.push_back(chars.size());
+				}
+				write(std::span<std::uint64_t const>(offsets));
+				write(std::span<char const>(chars));
+			}
+
+		 private:
+			std::ostream& os_;
+			std::size_t pos_ = 0;
+		};
+
+		class byte_reader {
+		 public:
+			byte_reader(std::span<std::byte const> bytes, char const* caller)
+			: bytes_(bytes)
+			, caller_(caller) {}
+
+			// views the next section, which must hold count values of T
+			template<typename T>
+			auto take(std::size_t count) -> std::span<T const> {
+				static_assert(std::is_trivially_copyable_v<T>);
+				if (count > (bytes_.size() - pos_) / sizeof(T)) {
+					fail();
+				}
+				auto res = std::span<T const>(reinterpret_cast<T const*>(bytes_.data() + pos_), count);
+				pos_ += count * sizeof(T);
+				pos_ = std::min(bytes_.size(), pos_ + (file_alignment - pos_ % file_alignment) % file_alignment);
+				return res;
+			}
+
+			// views the next section, which must hold the count + 1 bounds of count items
+			template<typename T>
+			auto take_bounds(std::size_t count) -> std::span<T const> {
+				if (count == std::numeric_limits<std::size_t>::max()) {
+					fail();
+				}
+				return take<T>(count + 1);
+			}
+
+			auto take_strings(std::size_t count) -> std::vector<std::string> {
+				auto offsets = take_bounds<std::uint64_t>(count);
+				if (offsets.front() != 0 or not std::ranges::is_sorted(offsets)) {
+					fail();
+				}
+				auto chars = take<char>(offsets.back());
+				auto res = std::vector<std::string>{};
+				res.reserve(count);
+				for (auto i = std::size_t{0}; i < count; ++i) {
+					res.emplace_back(chars.data() + offsets[i], chars.data() + offsets[i + 1]);
+				}
+				return res;
+			}
+
+			[[noreturn]] void fail() const {
+				auto emsg = std::string{"Cannot call gdwg::"} + caller_
+				            + " on data that isn't a graph file for this N and E";
+				throw std::runtime_error{emsg};
+			}
+
+		 private:
+			std::span<std::byte const> bytes_;
+			std::size_t pos_ = 0;
+			char const* caller_;
+		};
+
+		// maps the file at path read only, the mapping lasts until the storage is released
+		inline auto map_file(std::string const& path, char const* caller)
+		    -> std::pair<std::shared_ptr<void const>, std::span<std::byte const>> {
+			auto fail = [&path, caller]() {
+				auto emsg = std::string{"Cannot call gdwg::"} + caller + " on " + path + " as it can't be mapped";
+				throw std::runtime_error{emsg};
+			};
+			auto fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				fail();
+			}
+			struct stat info {};
+			if (::fstat(fd, &info) != 0 or info.st_size <= 0) {
+				::close(fd);
+				fail();
+			}
+			auto size = static_cast<std::size_t>(info.st_size);
+			auto* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if (addr == MAP_FAILED) {
+				fail();
+			}
+			auto storage = std::shared_ptr<void const>(addr, [size](void const* p) { ::munmap(const_cast<void*>(p), size); });
+			return {std::move(storage), std::span<std::byte const>(static_cast<std::byte const*>(addr), size)};
+		}
+
+		// builds a snapshot over bytes, viewing it in place when N and the weights are packed and
+		// decoding into owned arrays otherwise, storage is what keeps bytes alive
+		template<typename N, typename E>
+		auto decode(std::shared_ptr<void const> storage, std::span<std::byte const> bytes, char const* caller)
+		    -> csr_graph<N, E> {
+			static_assert(is_packed_v<N> or is_string_v<N>, "nodes must be trivially copyable or std::string");
+			static_assert(is_packed_v<E> or is_string_v<E>, "weights must be trivially copyable or std::string");
+			static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "offsets are stored as 64 bit values");
+			using node_id = typename csr_graph<N, E>::node_id;
+
+			auto reader = byte_reader(bytes, caller);
+			auto header = reader.take<file_header>(1).front();
+			auto expected = make_header<N, E>(header.num_nodes, header.num_edges);
+			if (std::memcmp(&header, &expected, sizeof(file_header)) != 0) {
+				reader.fail();
+			}
+			auto num_nodes = static_cast<std::size_t>(header.num_nodes);
+			auto num_edges = static_cast<std::size_t>(header.num_edges);
+
+			auto owned_nodes = std::vector<N>{};
+			auto nodes = std::span<N const>{};
+			if constexpr (is_packed_v<N>) {
+				nodes = reader.take<N>(num_nodes);
+			}
+			else {
+				owned_nodes = reader.take_strings(num_nodes);
+				nodes = owned_nodes;
+			}
+			auto offsets = reader.take_bounds<std::size_t>(num_nodes);
+			auto dsts = reader.take<node_id>(num_edges);
+			auto present = reader.take<std::uint8_t>(num_edges);
+			if (std::ranges::any_of(present, [](auto flag) { return flag > 1; })) {
+				reader.fail();
+			}
+			auto num_weights = static_cast<std::size_t>(std::ranges::count(present, 1));
+			auto values = [&reader, num_weights]() {
+				if constexpr (is_packed_v<E>) {
+					return reader.take<E>(num_weights);
+				}
+				else {
+					return reader.take_strings(num_weights);
+				}
+			}();
+			auto owned_weights = std::vector<std::optional<E>>(num_edges);
+			auto value = values.begin();
+			for (auto i = std::size_t{0}; i < num_edges; ++i) {
+				if (present[i] != 0) {
+					owned_weights[i] = std::move(*value++);
+				}
+			}
+			auto const weights = std::span<std::optional<E> const>(owned_weights);
+
+			// check the CSR invariants so a corrupt file can never be read out of bounds
+			auto not_less = [](auto const& a, auto const& b) { return not(a < b); };
+			if (std::ranges::adjacent_find(nodes, not_less) != nodes.end() or offsets.front() != 0
+			    or offsets.back() != num_edges or not std::ranges::is_sorted(offsets)) {
+				reader.fail();
+			}
+			for (auto src = std::size_t{0}; src < num_nodes; ++src) {
+				for (auto e = offsets[src]; e < offsets[src + 1]; ++e) {
+					if (dsts[e] >= num_nodes) {
+						reader.fail();
+					}
+					auto ordered = e == offsets[src] or dsts[e - 1] < dsts[e]
+					               or (dsts[e - 1] == dsts[e] and weights[e - 1] < weights[e]);
+					if (not ordered) {
+						reader.fail();
+					}
+				}
+			}
+
+			if constexpr (is_packed_v<N>) {
+				// the decoded weights are kept alive alongside the bytes the other arrays are viewed in
+				struct viewed_storage {
+					std::shared_ptr<void const> bytes;
+					std::vector<std::optional<E>> weights;
+				};
+				auto viewed = std::make_shared<viewed_storage const>(std::move(storage), std::move(owned_weights));
+				auto viewed_weights = std::span<std::optional<E> const>(viewed->weights);
+				return csr_graph<N, E>(std::move(viewed), nodes, offsets, dsts, viewed_weights);
+			}
+			else {
+				using arrays = typename csr_graph<N, E>::arrays;
+				auto owned_offsets = std::vector<std::size_t>(offsets.begin(), offsets.end());
+				auto owned_dsts = std::vector<node_id>(dsts.begin(), dsts.end());
+				return csr_graph<N, E>(
+				    arrays{std::move(owned_nodes), std::move(owned_offsets), std::move(owned_dsts), std::move(owned_weights)});
+			}
+		}
+	} // namespace detail
+
+	// writes g in the binary format
+	template<typename N, typename E>
+	auto save(csr_graph<N, E> const& g, std::ostream& os) -> void {
+		static_assert(detail::is_packed_v<N> or detail::is_string_v<N>, "nodes must be trivially copyable or std::string");
+		static_assert(detail::is_packed_v<E> or detail::is_string_v<E>, "weights must be trivially copyable or std::string");
+		auto writer = detail::byte_writer(os);
+		auto header = detail::make_header<N, E>(g.num_nodes(), g.num_edges());
+		writer.write(std::span<detail::file_header const>(&header, 1));
+		if constexpr (detail::is_packed_v<N>) {
+			writer.write(g.nodes());
+		}
+		else {
+			writer.write_strings(g.nodes());
+		}
+		auto offsets = std::vector<std::uint64_t>(g.offsets().begin(), g.offsets().end());
+		writer.write(std::span<std::uint64_t const>(offsets));
+		writer.write(g.destinations());
+		// each weight as a flag and, only when it is present, its value, so no byte of a disengaged
+		// optional or of its padding reaches the file
+		auto present = std::vector<std::uint8_t>{};
+		auto values = std::vector<E>{};
+		for (auto const& weight : g.weights()) {
+			present.push_back(weight.has_value() ? 1 : 0);
+			if (weight.has_value()) {
+				values.push_back(*weight);
+			}
+		}
+		writer.write(std::span<std::uint8_t const>(present));
+		if constexpr (detail::is_packed_v<E>) {
+			writer.write(std::span<E const>(values));
+		}
+		else {
+			writer.write_strings(values);
+		}
+	}
+
+	template<typename N, typename E, typename NodeIndex, typename InIndex, typename Instrument>
+	auto save(graph<N, E, NodeIndex, InIndex, Instrument> const& g, std::ostream& os) -> void {
+		save(csr_graph<N, E>(g), os);
+	}
+
+	// reads a snapshot written by save, with packed nodes every array but the weights is viewed in
+	// the read buffer
+	template<typename N, typename E>
+	auto load_csr(std::istream& is) -> csr_graph<N, E> {
+		auto buffer = std::make_shared<std::vector<char> const>(std::istreambuf_iterator<char>(is),
+		                                                         std::istreambuf_iterator<char>{});
+		auto bytes = std::as_bytes(std::span<char const>(*buffer));
+		return detail::decode<N, E>(std::move(buffer), bytes, "load_csr");
+	}
+
+	template<typename N, typename E>
+	auto load(std::istream& is) -> graph<N, E> {
+		auto snapshot = load_csr<N, E>(is);
+		auto nodes = snapshot.nodes();
+		return graph<N, E>(nodes.begin(), nodes.end(), snapshot.begin(), snapshot.end());
+	}
+
+	// memory maps a file written by save and serves it as a read-only snapshot. With trivially
+	// copyable nodes only the weights are decoded, the nodes, offsets and destinations are viewed in
+	// the mapping, which the snapshot keeps alive for as long as any copy of it exists.
+	template<typename N, typename E>
+	auto map_csr(std::string const& path) -> csr_graph<N, E> {
+		auto [storage, bytes] = detail::map_file(path, "map_csr");
+		return detail::decode<N, E>(std::move(storage), bytes, "map_csr");
+	}
+
+	// the text formats a graph can be parsed from: what graph's operator<< writes, and edge lists of
+	// "src\tdst" or "src\tdst\tweight" lines where an edge without a weight is unweighted. Edge lists
+	// skip blank lines and lines starting with #, and their nodes are the ends of their edges
+	enum class text_format { graph, edge_list };
+
+	namespace detail {
+		// the least text a thread is given to parse, and how much of a stream is read at a time
+		inline constexpr auto text_piece = std::size_t{64} * 1024;
+		inline constexpr auto text_block = std::size_t{16} * 1024 * 1024;
+
+		// an element of the range handed to graph::insert_edges
+		template<typename N, typename E>
+		using text_edge = std::conditional_t<std::is_void_v<E>, std::pair<N, N>, std::tuple<N, N, weight_t<E>>>;
+
+		template<typename T>
+		auto parse_token(std::string_view token, T& out) -> bool {
+			if constexpr (is_string_v<T>) {
+				out.assign(token);
+				return true;
+			}
+			else {
+				auto last = token.data() + token.size();
+				auto [ptr, ec] = std::from_chars(token.data(), last, out);
+				return ec == std::errc{} and ptr == last;
+			}
+		}
+
+		// the nodes and edges of some of the text, where lines counts the lines read and bad_line is
+		// the first that couldn't be parsed, counted from 0
+		template<typename N, typename E>
+		struct parsed_text {
+			std::vector<N> nodes;
+			std::vector<text_edge<N, E>> edges;
+			std::size_t lines = 0;
+			std::optional<std::size_t> bad_line;
+		};
+
+		template<typename N, typename E>
+		auto parse_edge(std::string_view src,
+		                std::string_view dst,
+		                std::optional<std::string_view> weight,
+		                parsed_text<N, E>& out) -> bool {
+			auto from = N{};
+			auto to = N{};
+			if (not parse_token(src, from) or not parse_token(dst, to)) {
+				return false;
+			}
+			if constexpr (std::is_void_v<E>) {
+				if (weight) {
+					return false;
+				}
+				out.edges.emplace_back(std::move(from), std::move(to));
+			}
+			else {
+				auto w = weight_t<E>{};
+				if (weight) {
+					auto value = E{};
+					if (not parse_token(*weight, value)) {
+						return false;
+					}
+					w = std::move(value);
+				}
+				out.edges.emplace_back(std::move(from), std::move(to), std::move(w));
+			}
+			return true;
+		}
+
+		// a line of graph's operator<<: blank, "node (", "  src -> dst | W | weight", "  src -> dst | U"
+		// or ")"
+		template<typename N, typename E>
+		auto parse_graph_line(std::string_view line, parsed_text<N, E>& out) -> bool {
+			if (line.empty() or line == ")") {
+				return true;
+			}
+			if (line.starts_with("  ")) {
+				auto body = line.substr(2);
+				auto arrow = body.find(" -> ");
+				if (arrow == std::string_view::npos) {
+					return false;
+				}
+				auto rest = body.substr(arrow + 4);
+				auto bar = rest.find(" | ");
+				if (bar == std::string_view::npos) {
+					return false;
+				}
+				auto tag = rest.substr(bar + 3);
+				auto weight = std::optional<std::string_view>{};
+				if (tag.starts_with("W | ")) {
+					weight = tag.substr(4);
+				}
+				else if (tag != "U") {
+					return false;
+				}
+				return parse_edge(body.substr(0, arrow), rest.substr(0, bar), weight, out);
+			}
+			if (line.ends_with(" (")) {
+				return parse_token(line.substr(0, line.size() - 2), out.nodes.emplace_back());
+			}
+			return false;
+		}
+
+		template<typename N, typename E>
+		auto parse_edge_list_line(std::string_view line, parsed_text<N, E>& out) -> bool {
+			if (line.empty() or line.front() == '#') {
+				return true;
+			}
+			auto tab = line.find('\t');
+			if (tab == std::string_view::npos) {
+				return false;
+			}
+			auto dst = line.substr(tab + 1);
+			auto weight = std::optional<std::string_view>{};
+			if (auto second = dst.find('\t'); second != std::string_view::npos) {
+				weight = dst.substr(second + 1);
+				dst = dst.substr(0, second);
+			}
+			if (not parse_edge(line.substr(0, tab), dst, weight, out)) {
+				return false;
+			}
+			out.nodes.push_back(std::get<0>(out.edges.back()));
+			out.nodes.push_back(std::get<1>(out.edges.back()));
+			return true;
+		}
+
+		template<typename N, typename E>
+		auto parse_piece(std::string_view text, text_format format) -> parsed_text<N, E> {
+			auto res = parsed_text<N, E>{};
+			while (not text.empty()) {
+				auto end = text.find('\n');
+				auto line = text.substr(0, end);
+				text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+				if (line.ends_with('\r')) {
+					line.remove_suffix(1);
+				}
+				auto parsed = format == text_format::graph ? parse_graph_line(line, res) : parse_edge_list_line(line, res);
+				if (not parsed) {
+					res.bad_line = res.lines;
+					return res;
+				}
+				++res.lines;
+			}
+			return res;
+		}
+
+		// cuts text into pieces that end on a line break, parses them over the threads and appends
+		// them in order to into, throwing on the first line that couldn't be parsed
+		template<typename N, typename E>
+		void parse_pieces(std::string_view text,
+		                  text_format format,
+		                  std::size_t threads,
+		                  parsed_text<N, E>& into,
+		                  char const* caller) {
+			auto pieces = std::vector<std::string_view>{};
+			auto const target = std::max(text_piece, text.size() / (threads * 4) + 1);
+			while (not text.empty()) {
+				auto end = text.size() <= target ? std::string_view::npos : text.find('\n', target);
+				auto size = end == std::string_view::npos ? text.size() : end + 1;
+				pieces.push_back(text.substr(0, size));
+				text.remove_prefix(size);
+			}
+			auto parsed = std::vector<parsed_text<N, E>>(pieces.size());
+			auto pool = worker_pool(threads);
+			pool.run(pieces.size(), 1, [&](auto first, auto last, auto) {
+				for (auto i = first; i != last; ++i) {
+					parsed[i] = parse_piece<N, E>(pieces[i], format);
+				}
+			});
+			for (auto& piece : parsed) {
+				if (piece.bad_line) {
+					auto line = std::to_string(into.lines + *piece.bad_line + 1);
+					auto expected = format == text_format::graph ? "in the format of graph's operator<<"
+					                                             : "a tab separated edge";
+					auto emsg = std::string{"Cannot call gdwg::"} + caller + " as line " + line + " isn't " + expected;
+					throw std::runtime_error{emsg};
+				}
+				into.lines += piece.lines;
+				into.nodes.insert(into.nodes.end(),
+				                  std::make_move_iterator(piece.nodes.begin()),
+				                  std::make_move_iterator(piece.nodes.end()));
+				into.edges.insert(into.edges.end(),
+				                  std::make_move_iterator(piece.edges.begin()),
+				                  std::make_move_iterator(piece.edges.end()));
+			}
+		}
+
+		// the nodes go in with one sort, already done for the text of operator<<, and the edges with
+		// one bulk insert
+		template<typename N, typename E>
+		auto build_graph(parsed_text<N, E>& parsed) -> graph<N, E> {
+			auto& nodes = parsed.nodes;
+			if (not std::is_sorted(nodes.begin(), nodes.end())) {
+				std::sort(nodes.begin(), nodes.end());
+			}
+			nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+			auto g = graph<N, E>(sorted_unique, std::make_move_iterator(nodes.begin()), std::make_move_iterator(nodes.end()));
+			g.insert_edges(parsed.edges.begin(), parsed.edges.end());
+			return g;
+		}
+
+		template<typename N, typename E>
+		constexpr void check_text_types() {
+			static_assert(std::is_arithmetic_v<N> or is_string_v<N>, "nodes must be arithmetic or std::string");
+			static_assert(std::is_void_v<E> or std::is_arithmetic_v<E> or is_string_v<E>,
+			              "weights must be arithmetic or std::string");
+		}
+	} // namespace detail
+
+	// the graph written as text in format. The text is parsed in pieces spread over the threads,
+	// arithmetic nodes and weights with std::from_chars, and the graph is built with one bulk insert
+	template<typename N, typename E>
+	auto parse_text(std::string_view text,
+	                text_format format = text_format::graph,
+	                std::size_t threads = detail::default_threads()) -> graph<N, E> {
+		detail::check_text_types<N, E>();
+		auto parsed = detail::parsed_text<N, E>{};
+		detail::parse_pieces(text, format, std::max(threads, std::size_t{1}), parsed, "parse_text");
+		return detail::build_graph(parsed);
+	}
+
+	// as parse_text, reading is a block at a time. The lines a block ends in the middle of wait for
+	// the next, so only one block of text is held at once
+	template<typename N, typename E>
+	auto load_text(std::istream& is,
+	               text_format format = text_format::graph,
+	               std::size_t threads = detail::default_threads()) -> graph<N, E> {
+		detail::check_text_types<N, E>();
+		threads = std::max(threads, std::size_t{1});
+		auto parsed = detail::parsed_text<N, E>{};
+		auto buffer = std::string{};
+		while (true) {
+			auto kept = buffer.size();
+			buffer.resize(kept + detail::text_block);
+			is.read(buffer.data() + kept, static_cast<std::streamsize>(detail::text_block));
+			buffer.resize(kept + static_cast<std::size_t>(is.gcount()));
+			auto done = not is;
+			auto text = std::string_view{buffer};
+			auto cut = done ? text.size() : text.rfind('\n');
+			auto complete = cut == std::string_view::npos ? 0 : done ? cut : cut + 1;
+			detail::parse_pieces(text.substr(0, complete), format, threads, parsed, "load_text");
+			buffer.erase(0, complete);
+			if (done) {
+				break;
+			}
+		}
+		return detail::build_graph(parsed);
+	}
+
+	// as parse_text, over the memory mapped file at path
+	template<typename N, typename E>
+	auto map_text(std::string const& path,
+	              text_format format = text_format::graph,
+	              std::size_t threads = detail::default_threads()) -> graph<N, E> {
+		detail::check_text_types<N, E>();
+		auto [storage, bytes] = detail::map_file(path, "map_text");
+		auto text = std::string_view(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+		auto parsed = detail::parsed_text<N, E>{};
+		detail::parse_pieces(text, format, std::max(threads, std::size_t{1}), parsed, "map_text");
+		return detail::build_graph(parsed);
+	}
+} // namespace gdwg
+
+#endif // GDWG_IO_H
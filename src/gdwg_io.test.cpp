@@ -0,0 +1,200 @@
+#include "gdwg_io.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+	template<typename N, typename E>
+	auto round_trip(gdwg::graph<N, E> const& g) -> gdwg::graph<N, E> {
+		auto buffer = std::stringstream{};
+		gdwg::save(g, buffer);
+		return gdwg::load<N, E>(buffer);
+	}
+} // namespace
+
+TEST_CASE("save and load round trip") {
+	SECTION("packed nodes and weights") {
+		auto g = gdwg::graph<int, int>{1, 2, 3, 7};
+		g.insert_edge(1, 2, 4);
+		g.insert_edge(1, 2);
+		g.insert_edge(3, 1, -2);
+		g.insert_edge(3, 3, 0);
+		CHECK(round_trip(g) == g);
+	}
+	SECTION("string nodes") {
+		auto g = gdwg::graph<std::string, double>{"", "alpha", "beta"};
+		g.insert_edge("alpha", "", 0.5);
+		g.insert_edge("beta", "alpha");
+		CHECK(round_trip(g) == g);
+	}
+	SECTION("string weights") {
+		auto g = gdwg::graph<int, std::string>{1, 2};
+		g.insert_edge(1, 2, "x");
+		g.insert_edge(1, 2, "");
+		g.insert_edge(2, 1);
+		CHECK(round_trip(g) == g);
+	}
+	SECTION("empty graph") {
+		CHECK(round_trip(gdwg::graph<int, int>{}).empty());
+	}
+	SECTION("weights are written as a flag and only the values present") {
+		auto g = gdwg::graph<int, int>{1, 2};
+		g.insert_edge(1, 2, 3);
+		g.insert_edge(1, 2);
+		auto buffer = std::stringstream{};
+		gdwg::save(g, buffer);
+		auto bytes = buffer.str();
+		// header, nodes, offsets and dsts take 48 + 16 + 32 + 16 bytes, the unweighted edge is first
+		REQUIRE(bytes.size() == 144);
+		CHECK(bytes.substr(112, 16) == std::string{"\0\1", 2} + std::string(14, '\0'));
+		auto weight = 0;
+		std::memcpy(&weight, bytes.data() + 128, sizeof(weight));
+		CHECK(weight == 3);
+		CHECK(bytes.substr(132) == std::string(12, '\0'));
+		CHECK(round_trip(g) == g);
+	}
+	SECTION("load_csr") {
+		auto g = gdwg::graph<std::string, int>{"A", "B"};
+		g.insert_edge("A", "B", 1);
+		auto buffer = std::stringstream{};
+		gdwg::save(g, buffer);
+		auto c = gdwg::load_csr<std::string, int>(buffer);
+		CHECK(c == gdwg::csr_graph<std::string, int>{g});
+	}
+}
+
+TEST_CASE("load rejects bad data") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	g.insert_edge(1, 2, 3);
+	auto buffer = std::stringstream{};
+	gdwg::save(g, buffer);
+	auto bytes = buffer.str();
+	auto const emsg = std::string{"Cannot call gdwg::load_csr on data that isn't a graph file for this N and E"};
+	SECTION("different N") {
+		auto in = std::stringstream{bytes};
+		CHECK_THROWS_WITH((gdwg::load_csr<std::string, int>(in)), emsg);
+	}
+	SECTION("truncated") {
+		auto in = std::stringstream{bytes.substr(0, bytes.size() / 2)};
+		CHECK_THROWS_WITH((gdwg::load_csr<int, int>(in)), emsg);
+	}
+	SECTION("counts too large for the data") {
+		// num_nodes follows the magic and five u32 fields of the header
+		auto count = std::numeric_limits<std::uint64_t>::max();
+		std::memcpy(bytes.data() + 24, &count, sizeof(count));
+		auto in = std::stringstream{bytes};
+		CHECK_THROWS_WITH((gdwg::load_csr<int, int>(in)), emsg);
+		auto strings = std::stringstream{};
+		gdwg::save(gdwg::graph<std::string, int>{"A"}, strings);
+		auto string_bytes = strings.str();
+		std::memcpy(string_bytes.data() + 24, &count, sizeof(count));
+		auto string_in = std::stringstream{string_bytes};
+		CHECK_THROWS_WITH((gdwg::load_csr<std::string, int>(string_in)), emsg);
+	}
+	SECTION("header cut short") {
+		auto in = std::stringstream{bytes.substr(0, 20)};
+		CHECK_THROWS_WITH((gdwg::load_csr<int, int>(in)), emsg);
+	}
+	SECTION("destination out of range") {
+		// the only dst id sits right after the header, the nodes and the offsets sections
+		bytes[48 + 16 + 32] = 9;
+		auto in = std::stringstream{bytes};
+		CHECK_THROWS_WITH((gdwg::load_csr<int, int>(in)), emsg);
+	}
+}
+
+TEST_CASE("map_csr") {
+	auto g = gdwg::graph<int, int>{1, 2, 3};
+	g.insert_edge(1, 2, 4);
+	g.insert_edge(2, 3);
+	auto path = (std::filesystem::temp_directory_path() / "gdwg_io_test.bin").string();
+	{
+		auto out = std::ofstream{path, std::ios::binary};
+		gdwg::save(g, out);
+	}
+	auto c = gdwg::map_csr<int, int>(path);
+	std::remove(path.c_str());
+	// the mapping outlives the file name
+	CHECK(c == gdwg::csr_graph<int, int>{g});
+	CHECK(c.is_connected(1, 2));
+	CHECK(c.connections(2) == std::vector<int>{3});
+	CHECK_THROWS_WITH((gdwg::map_csr<int, int>(path)), "Cannot call gdwg::map_csr on " + path + " as it can't be mapped");
+}
+
+TEST_CASE("Parsing text") {
+	SECTION("what operator<< writes reads back as the same graph") {
+		auto g = gdwg::graph<int, double>{1, 2, 3, 7};
+		g.insert_edge(1, 2, 0.5);
+		g.insert_edge(1, 2);
+		g.insert_edge(2, 1, -4);
+		g.insert_edge(3, 3, 1e3);
+		auto out = std::ostringstream{};
+		out << g;
+		CHECK(gdwg::parse_text<int, double>(out.str()) == g);
+	}
+	SECTION("string nodes and weights may hold spaces") {
+		auto g = gdwg::graph<std::string, std::string>{"New York", "Sydney", "Lonely"};
+		g.insert_edge("New York", "Sydney", "by air");
+		g.insert_edge("Sydney", "New York");
+		auto out = std::ostringstream{};
+		out << g;
+		auto in = std::istringstream{out.str()};
+		CHECK(gdwg::load_text<std::string, std::string>(in) == g);
+	}
+	SECTION("edge lists") {
+		auto g = gdwg::parse_text<int, int>("1\t2\t5\n2\t3\n# a comment\n\n3\t1\t-4\r\n",
+		                                    gdwg::text_format::edge_list);
+		CHECK(g.nodes() == std::vector<int>{1, 2, 3});
+		CHECK(g.is_connected(1, 2));
+		CHECK_FALSE(g.edges(2, 3)[0]->is_weighted());
+		CHECK(g.edges(3, 1)[0]->get_weight() == -4);
+		auto u = gdwg::parse_text<std::string, void>("a\tb\nb\ta\nb\ta", gdwg::text_format::edge_list);
+		CHECK(u.connections("b") == std::vector<std::string>{"a"});
+		CHECK(gdwg::parse_text<int, int>("", gdwg::text_format::edge_list).empty());
+	}
+	SECTION("lines that don't parse are reported by number") {
+		CHECK_THROWS_WITH((gdwg::parse_text<int, int>("\n1 (\n  1 -> 1 | W | x\n)\n")),
+		                  "Cannot call gdwg::parse_text as line 3 isn't in the format of graph's operator<<");
+		CHECK_THROWS_WITH((gdwg::parse_text<int, int>("1\t2\n1 2\n", gdwg::text_format::edge_list)),
+		                  "Cannot call gdwg::parse_text as line 2 isn't a tab separated edge");
+		CHECK_THROWS_WITH((gdwg::parse_text<int, void>("1\t2\t3\n", gdwg::text_format::edge_list)),
+		                  "Cannot call gdwg::parse_text as line 1 isn't a tab separated edge");
+	}
+	SECTION("large inputs parse the same in pieces, from a stream and from a file") {
+		auto rng = std::mt19937{6771};
+		auto pick = std::uniform_int_distribution<int>{0, 4999};
+		auto edges = std::string{};
+		for (auto i = 0; i < 40000; ++i) {
+			edges += std::to_string(pick(rng)) + '\t' + std::to_string(pick(rng)) + '\t' + std::to_string(i % 17) + '\n';
+		}
+		auto g = gdwg::parse_text<int, int>(edges, gdwg::text_format::edge_list, 1);
+		CHECK(std::distance(g.begin(), g.end()) > 30000);
+		CHECK(gdwg::parse_text<int, int>(edges, gdwg::text_format::edge_list, 4) == g);
+		auto printed = std::ostringstream{};
+		printed << g;
+		CHECK(gdwg::parse_text<int, int>(printed.str(), gdwg::text_format::graph, 4) == g);
+		// each call asks for more threads than the last, with its own workers
+		for (auto threads : {std::size_t{1}, std::size_t{2}, std::size_t{8}}) {
+			auto in = std::istringstream{printed.str()};
+			CHECK(gdwg::load_text<int, int>(in, gdwg::text_format::graph, threads) == g);
+		}
+
+		auto path = (std::filesystem::temp_directory_path() / "gdwg_io_test.tsv").string();
+		{
+			auto out = std::ofstream{path, std::ios::binary};
+			out << edges;
+		}
+		auto mapped = gdwg::map_text<int, int>(path, gdwg::text_format::edge_list);
+		std::remove(path.c_str());
+		CHECK(mapped == g);
+	}
+}
@@ -0,0 +1,781 @@
+#ifndef GDWG_PARALLEL_H
+#	define GDWG_PARALLEL_H
+
+#	include "gdwg_csr.h"
+
+#	include <algorithm>
+#	include <atomic>
+#	include <bit>
+#	include <condition_variable>
+#	include <cstdint>
+#	include <exception>
+#	include <limits>
+#	include <mutex>
+#	include <numeric>
+#	include <optional>
+#	include <span>
+#	include <stdexcept>
+#	include <string>
+#	include <thread>
+#	include <utility>
+#	include <vector>
+
+namespace gdwg {
+	namespace detail {
+		inline auto default_threads() noexcept -> std::size_t {
+			return std::max(1U, std::thread::hardware_concurrency());
+		}
+
+		// Threads kept for a whole search, so one that runs a loop per level or round doesn't start
+		// new ones every time. run() calls f(first, last, worker) over [0, count) in chunks that the
+		// workers claim from a shared counter, so a worker that finishes early takes over the chunks
+		// the others haven't reached yet. The calling thread is worker 0, and a thread only starts
+		// once a loop has a chunk for it. The first exception thrown by f stops the chunks being
+		// handed out and is rethrown by run() once every worker has stopped
+		class worker_pool {
+		 public:
+			explicit worker_pool(std::size_t threads)
+			: threads_{std::max(threads, std::size_t{1})} {}
+
+			worker_pool(worker_pool const&) = delete;
+			auto operator=(worker_pool const&) -> worker_pool& = delete;
+
+			~worker_pool() {
+				{
+					auto const lock = std::scoped_lock{mutex_};
+					stopping_ = true;
+				}
+				wake_.notify_all();
+			}
+
+			[[nodiscard]] auto threads() const noexcept -> std::size_t {
+				return threads_;
+			}
+
+			template<typename F>
+			void run(std::size_t count, std::size_t chunk, F const& f) {
+				auto const workers = std::min(threads_, (count + chunk - 1) / chunk);
+				if (workers <= 1) {
+					for (auto first = std::size_t{0}; first < count; first += chunk) {
+						f(first, std::min(first + chunk, count), std::size_t{0});
+					}
+					return;
+				}
+				auto j = job{count, chunk, workers, &f, &call<F>};
+				j.pending = workers - 1;
+				{
+					auto const lock = std::scoped_lock{mutex_};
+					// a new helper starts from the loops already run, so it waits for this one
+					while (helpers_.size() + 1 < workers) {
+						helpers_.emplace_back(
+						   [this, worker = helpers_.size() + 1, seen = generation_] { serve(worker, seen); });
+					}
+					job_ = &j;
+					++generation_;
+				}
+				wake_.notify_all();
+				work(j, 0);
+				{
+					auto lock = std::unique_lock{mutex_};
+					done_.wait(lock, [&j] { return j.pending == 0; });
+					job_ = nullptr;
+				}
+				if (j.error) {
+					std::rethrow_exception(j.error);
+				}
+			}
+
+		 private:
+			struct job {
+				std::size_t count;
+				std::size_t chunk;
+				std::size_t workers;
+				void const* f;
+				void (*call)(void const*, std::size_t, std::size_t, std::size_t);
+				std::atomic<std::size_t> next{0};
+				// the helpers still working, and the first exception, both guarded by mutex_
+				std::size_t pending{0};
+				std::exception_ptr error{};
+			};
+
+			std::size_t threads_;
+			std::mutex mutex_;
+			std::condition_variable wake_;
+			std::condition_variable done_;
+			job* job_ = nullptr;
+			std::uint64_t generation_ = 0;
+			bool stopping_ = false;
+			// last, so the threads are joined before what they wait on is destroyed
+			std::vector<std::jthread> helpers_;
+
+			template<typename F>
+			static void call(void const* f, std::size_t first, std::size_t last, std::size_t worker) {
+				(*static_cast<F const*>(f))(first, last, worker);
+			}
+
+			void work(job& j, std::size_t worker) noexcept {
+				try {
+					for (auto first = j.next.fetch_add(j.chunk); first < j.count; first = j.next.fetch_add(j.chunk)) {
+						j.call(j.f, first, std::min(first + j.chunk, j.count), worker);
+					}
+				} catch (...) {
+					auto const lock = std::scoped_lock{mutex_};
+					if (not j.error) {
+						j.error = std::current_exception();
+					}
+					j.next.store(j.count);
+				}
+			}
+
+			// a helper joins every loop it has a chunk for, and run() waits for it, so it can't miss one.
+			// seen is the last loop the helper has skipped or joined, and a wake after run() has
+			// finished with a loop finds no job and goes back to waiting
+			void serve(std::size_t worker, std::uint64_t seen) noexcept {
+				while (true) {
+					auto j = static_cast<job*>(nullptr);
+					{
+						auto lock = std::unique_lock{mutex_};
+						wake_.wait(lock, [&] { return stopping_ or generation_ != seen; });
+						if (stopping_) {
+							return;
+						}
+						seen = generation_;
+						j = job_;
+						if (j == nullptr or worker >= j->workers) {
+							continue;
+						}
+					}
+					work(*j, worker);
+					auto last = false;
+					{
+						auto const lock = std::scoped_lock{mutex_};
+						last = --j->pending == 0;
+					}
+					if (last) {
+						done_.notify_one();
+					}
+				}
+			}
+		};
+
+		// the edges of a csr_graph reversed, the srcs of the edges into v are in(v), sorted
+		struct reversed_rows {
+			std::vector<std::size_t> offsets;
+			std::vector<std::uint32_t> srcs;
+
+			[[nodiscard]] auto in(std::uint32_t v) const noexcept -> std::span<std::uint32_t const> {
+				return std::span{srcs}.subspan(offsets[v], offsets[v + 1] - offsets[v]);
+			}
+		};
+
+		template<typename N, typename E>
+		auto reverse_rows(csr_graph<N, E> const& g) -> reversed_rows {
+			auto res = reversed_rows{};
+			res.offsets.assign(g.num_nodes() + 1, 0);
+			res.srcs.resize(g.num_edges());
+			for (auto dst : g.destinations()) {
+				++res.offsets[dst + 1];
+			}
+			std::partial_sum(res.offsets.begin(), res.offsets.end(), res.offsets.begin());
+			auto fill = std::vector<std::size_t>(res.offsets.begin(), res.offsets.end() - 1);
+			for (auto src = std::uint32_t{0}; src < g.num_nodes(); ++src) {
+				for (auto dst : g.neighbours(src)) {
+					res.srcs[fill[dst]++] = src;
+				}
+			}
+			return res;
+		}
+
+		// one bit per node, set by whichever thread claims the node first
+		class node_bitmap {
+		 public:
+			explicit node_bitmap(std::size_t n)
+			: words_((n + 63) / 64) {}
+
+			auto claim(std::uint32_t v) noexcept -> bool {
+				auto bit = std::uint64_t{1} << (v % 64);
+				return (words_[v / 64].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+			}
+
+			[[nodiscard]] auto test(std::uint32_t v) const noexcept -> bool {
+				return ((words_[v / 64].load(std::memory_order_relaxed) >> (v % 64)) & 1) != 0;
+			}
+
+			// the lowest node whose bit is set, or n if there is none
+			[[nodiscard]] auto first(std::size_t n) const noexcept -> std::size_t {
+				for (auto word = std::size_t{0}; word != words_.size(); ++word) {
+					if (auto bits = words_[word].load(std::memory_order_relaxed); bits != 0) {
+						return word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+					}
+				}
+				return n;
+			}
+
+		 private:
+			std::vector<std::atomic<std::uint64_t>> words_;
+		};
+
+		// the nodes reached from src by following next(v) through nodes for which allowed(v) holds,
+		// expanded a level at a time with the frontier spread over the threads
+		template<typename Next, typename Allowed>
+		auto parallel_reach(worker_pool& pool, std::size_t n, std::uint32_t src, Next const& next, Allowed const& allowed)
+		    -> node_bitmap {
+			auto reached = node_bitmap(n);
+			auto outputs = std::vector<std::vector<std::uint32_t>>(pool.threads());
+			reached.claim(src);
+			auto frontier = std::vector<std::uint32_t>{src};
+			while (not frontier.empty()) {
+				pool.run(frontier.size(), 64, [&](auto first, auto last, auto worker) {
+					for (auto i = first; i != last; ++i) {
+						for (auto w : next(frontier[i])) {
+							if (allowed(w) and reached.claim(w)) {
+								outputs[worker].push_back(w);
+							}
+						}
+					}
+				});
+				frontier.clear();
+				for (auto& out : outputs) {
+					frontier.insert(frontier.end(), out.begin(), out.end());
+					out.clear();
+				}
+			}
+			return reached;
+		}
+
+		// Lock free union find over node ids. A root is only ever linked below a smaller root, so
+		// parent[v] <= v always holds and the root of a set is its smallest node. find() halves the
+		// path it walks, a lost compare exchange there only means the path stays longer
+		class union_find {
+		 public:
+			explicit union_find(std::size_t n)
+			: parent_(n) {
+				for (auto v = std::size_t{0}; v != n; ++v) {
+					parent_[v].store(static_cast<std::uint32_t>(v), std::memory_order_relaxed);
+				}
+			}
+
+			auto find(std::uint32_t v) noexcept -> std::uint32_t {
+				auto parent = parent_[v].load(std::memory_order_relaxed);
+				while (parent != v) {
+					auto grandparent = parent_[parent].load(std::memory_order_relaxed);
+					parent_[v].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+					v = grandparent;
+					parent = parent_[v].load(std::memory_order_relaxed);
+				}
+				return v;
+			}
+
+			void unite(std::uint32_t a, std::uint32_t b) noexcept {
+				while (true) {
+					a = find(a);
+					b = find(b);
+					if (a == b) {
+						return;
+					}
+					if (a < b) {
+						std::swap(a, b);
+					}
+					// a is still a root, or another thread linked it first and we go round again
+					auto expected = a;
+					if (parent_[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+						return;
+					}
+				}
+			}
+
+		 private:
+			std::vector<std::atomic<std::uint32_t>> parent_;
+		};
+	} // namespace detail
+
+	// Reachability over a CSR snapshot, shared by many threads. Construction adds the reverse edges
+	// so a traversal can pull from the frontier as well as push to it. Every member is const and
+	// allocates its own scratch space and threads, kept for the whole query, so queries may also run
+	// concurrently.
+	template<typename N, typename E>
+	class reachability {
+	 public:
+		using node_id = typename csr_graph<N, E>::node_id;
+		using query = std::pair<node_id, node_id>;
+		static constexpr auto unreached = std::numeric_limits<std::uint32_t>::max();
+
+		// g must outlive the reachability
+		explicit reachability(csr_graph<N, E> const& g, std::size_t threads = detail::default_threads())
+		: g_{&g}
+		, threads_{std::max(threads, std::size_t{1})}
+		, in_{detail::reverse_rows(g)} {}
+
+		// the number of hops from src to every node, or unreached. Each level of the search is expanded
+		// in parallel, top down from the frontier while it is small and bottom up, every unvisited
+		// node looking for a parent in the frontier, once the frontier holds most of the remaining work
+		[[nodiscard]] auto bfs(node_id src) const -> std::vector<std::uint32_t> {
+			auto const n = g_->num_nodes();
+			auto levels = std::vector<std::uint32_t>(n, unreached);
+			auto visited = std::vector<std::atomic<std::uint64_t>>((n + 63) / 64);
+			auto frontier_bits = std::vector<std::uint64_t>{};
+			auto outputs = std::vector<std::vector<node_id>>(threads_);
+			auto pool = detail::worker_pool(threads_);
+			auto claim = [&](node_id v) {
+				auto bit = std::uint64_t{1} << (v % 64);
+				return (visited[v / 64].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+			};
+
+			claim(src);
+			levels[src] = 0;
+			auto frontier = std::vector<node_id>{src};
+			auto unexplored = g_->num_edges();
+			auto bottom_up = false;
+			for (auto depth = std::uint32_t{1}; not frontier.empty(); ++depth) {
+				auto frontier_edges = std::size_t{0};
+				for (auto v : frontier) {
+					frontier_edges += out_degree(v);
+				}
+				unexplored -= std::min(unexplored, frontier_edges);
+				// the switching thresholds from Beamer et al., "Direction-Optimizing Breadth-First Search"
+				bottom_up = bottom_up ? frontier.size() >= n / 24 : frontier_edges > unexplored / 14;
+
+				if (bottom_up) {
+					frontier_bits.assign(visited.size(), 0);
+					for (auto v : frontier) {
+						frontier_bits[v / 64] |= std::uint64_t{1} << (v % 64);
+					}
+					// chunks are whole words, so each word of visited is only written by one thread
+					pool.run(visited.size(), 16, [&](auto first, auto last, auto worker) {
+						for (auto word = first; word != last; ++word) {
+							auto todo = ~visited[word].load(std::memory_order_relaxed);
+							for (; todo != 0; todo &= todo - 1) {
+								auto v = static_cast<node_id>(word * 64 + static_cast<std::size_t>(std::countr_zero(todo)));
+								if (v >= n) {
+									break;
+								}
+								for (auto u : in_neighbours(v)) {
+									if ((frontier_bits[u / 64] >> (u % 64)) & 1) {
+										claim(v);
+										levels[v] = depth;
+										outputs[worker].push_back(v);
+										break;
+									}
+								}
+							}
+						}
+					});
+				}
+				else {
+					pool.run(frontier.size(), 64, [&](auto first, auto last, auto worker) {
+						for (auto i = first; i != last; ++i) {
+							for (auto dst : g_->neighbours(frontier[i])) {
+								if (claim(dst)) {
+									levels[dst] = depth;
+									outputs[worker].push_back(dst);
+								}
+							}
+						}
+					});
+				}
+
+				frontier.clear();
+				for (auto& out : outputs) {
+					frontier.insert(frontier.end(), out.begin(), out.end());
+					out.clear();
+				}
+			}
+			return levels;
+		}
+
+		[[nodiscard]] auto is_reachable(N const& src, N const& dst) const -> bool {
+			auto src_id = g_->id(src);
+			auto dst_id = g_->id(dst);
+			if (src_id and dst_id) {
+				auto q = query{*src_id, *dst_id};
+				return is_reachable(std::span<query const>{&q, 1}).front();
+			}
+			auto emsg = std::string{"Cannot call gdwg::reachability<N, E>::is_reachable if src or dst node don't exist "
+			                        "in the graph"};
+			throw std::runtime_error{emsg};
+		}
+
+		// answers every (src, dst) query, whether dst can be reached from src. Queries are grouped by src
+		// and every 64 distinct sources are searched together, one bit of a word per source, so a node
+		// is expanded once per group rather than once per source. The groups are spread over the
+		// threads, and each search stops as soon as its group has no unanswered query left
+		[[nodiscard]] auto is_reachable(std::span<query const> queries) const -> std::vector<bool> {
+			auto order = std::vector<std::size_t>(queries.size());
+			std::iota(order.begin(), order.end(), std::size_t{0});
+			std::sort(order.begin(), order.end(), [&](auto a, auto b) { return queries[a].first < queries[b].first; });
+
+			// groups[i] is where the queries of the ith group of 64 sources start in order
+			auto groups = std::vector<std::size_t>{};
+			auto sources = std::size_t{0};
+			for (auto i = std::size_t{0}; i != order.size(); ++i) {
+				if (i == 0 or queries[order[i]].first != queries[order[i - 1]].first) {
+					if (sources++ % 64 == 0) {
+						groups.push_back(i);
+					}
+				}
+			}
+			groups.push_back(order.size());
+
+			auto answers = std::vector<char>(queries.size(), 0);
+			auto scratch = std::vector<multi_source_state>(threads_);
+			auto pool = detail::worker_pool(threads_);
+			pool.run(groups.size() - 1, 1, [&](auto first, auto last, auto worker) {
+				for (auto group = first; group != last; ++group) {
+					search_group(queries, std::span{order}.subspan(groups[group], groups[group + 1] - groups[group]),
+					             answers,
+					             scratch[worker]);
+				}
+			});
+			return std::vector<bool>(answers.begin(), answers.end());
+		}
+
+	 private:
+		csr_graph<N, E> const* g_;
+		std::size_t threads_;
+		detail::reversed_rows in_;
+
+		// bit k of a word is about the kth source of the group being searched
+		struct multi_source_state {
+			std::vector<std::uint64_t> seen;
+			std::vector<std::uint64_t> frontier;
+			std::vector<std::uint64_t> next;
+			std::vector<node_id> active;
+			std::vector<node_id> reached;
+			std::vector<std::pair<std::size_t, std::size_t>> pending;
+		};
+
+		auto out_degree(node_id v) const noexcept -> std::size_t {
+			return g_->offsets()[v + 1] - g_->offsets()[v];
+		}
+
+		auto in_neighbours(node_id v) const noexcept -> std::span<node_id const> {
+			return in_.in(v);
+		}
+
+		// group holds the indices of the queries of up to 64 sources, sorted by source
+		void search_group(std::span<query const> queries,
+		                  std::span<std::size_t const> group,
+		                  std::vector<char>& answers,
+		                  multi_source_state& s) const {
+			s.seen.assign(g_->num_nodes(), 0);
+			s.frontier.assign(g_->num_nodes(), 0);
+			s.next.assign(g_->num_nodes(), 0);
+			s.active.clear();
+			s.pending.clear();
+
+			// pending pairs each unanswered query with the bit of its source
+			auto bit = std::size_t{0};
+			for (auto i = std::size_t{0}; i != group.size(); ++i) {
+				auto src = queries[group[i]].first;
+				if (i != 0 and src != queries[group[i - 1]].first) {
+					++bit;
+				}
+				auto mask = std::uint64_t{1} << bit;
+				if (s.frontier[src] == 0) {
+					s.active.push_back(src);
+				}
+				s.seen[src] |= mask;
+				s.frontier[src] |= mask;
+				s.pending.emplace_back(group[i], bit);
+			}
+
+			auto answer = [&] {
+				std::erase_if(s.pending, [&](auto const& p) {
+					auto [q, k] = p;
+					if ((s.seen[queries[q].second] >> k) & 1) {
+						answers[q] = 1;
+						return true;
+					}
+					return false;
+				});
+			};
+			answer();
+
+			while (not s.active.empty() and not s.pending.empty()) {
+				s.reached.clear();
+				for (auto v : s.active) {
+					auto bits = s.frontier[v];
+					for (auto w : g_->neighbours(v)) {
+						auto add = bits & ~s.seen[w];
+						if (add != 0) {
+							if (s.next[w] == 0) {
+								s.reached.push_back(w);
+							}
+							s.next[w] |= add;
+						}
+					}
+				}
+				for (auto v : s.active) {
+					s.frontier[v] = 0;
+				}
+				for (auto w : s.reached) {
+					s.seen[w] |= s.next[w];
+					s.frontier[w] = std::exchange(s.next[w], 0);
+				}
+				std::swap(s.active, s.reached);
+				answer();
+			}
+		}
+	};
+
+	// the weakly connected component of every node, by id, as the smallest id in its component.
+	// Every edge unites its ends in a lock free union find, the rows spread over the threads
+	template<typename N, typename E>
+	auto weakly_connected_components(csr_graph<N, E> const& g, std::size_t threads = detail::default_threads())
+	    -> std::vector<std::uint32_t> {
+		auto pool = detail::worker_pool(threads);
+		auto const n = g.num_nodes();
+		auto sets = detail::union_find(n);
+		pool.run(n, 256, [&](auto first, auto last, auto) {
+			for (auto v = first; v != last; ++v) {
+				auto src = static_cast<std::uint32_t>(v);
+				for (auto dst : g.neighbours(src)) {
+					sets.unite(src, dst);
+				}
+			}
+		});
+		auto components = std::vector<std::uint32_t>(n);
+		pool.run(n, 4096, [&](auto first, auto last, auto) {
+			for (auto v = first; v != last; ++v) {
+				components[v] = sets.find(static_cast<std::uint32_t>(v));
+			}
+		});
+		return components;
+	}
+
+	namespace detail {
+		// Tarjan's algorithm, without recursion, over the nodes of group and the edges between two
+		// nodes for which member holds. index, low and on_stack are shared by every group, which are
+		// disjoint, and every component found is labelled with its smallest id
+		template<typename N, typename E, typename Member>
+		void tarjan(csr_graph<N, E> const& g,
+		            std::span<std::uint32_t const> group,
+		            Member const& member,
+		            std::vector<std::uint32_t>& index,
+		            std::vector<std::uint32_t>& low,
+		            std::vector<char>& on_stack,
+		            std::vector<std::uint32_t>& components) {
+			struct frame {
+				std::uint32_t v;
+				std::size_t next;
+			};
+			auto frames = std::vector<frame>{};
+			auto stack = std::vector<std::uint32_t>{};
+			auto counter = std::uint32_t{0};
+			auto visit = [&](std::uint32_t v) {
+				index[v] = low[v] = ++counter;
+				on_stack[v] = 1;
+				stack.push_back(v);
+				frames.push_back(frame{v, g.offsets()[v]});
+			};
+			for (auto root : group) {
+				if (index[root] != 0) {
+					continue;
+				}
+				visit(root);
+				while (not frames.empty()) {
+					auto const v = frames.back().v;
+					if (auto& next = frames.back().next; next != g.offsets()[v + 1]) {
+						auto w = g.destinations()[next++];
+						if (not member(w)) {
+							continue;
+						}
+						if (index[w] == 0) {
+							visit(w);
+						}
+						else if (on_stack[w] != 0) {
+							low[v] = std::min(low[v], index[w]);
+						}
+						continue;
+					}
+					frames.pop_back();
+					if (not frames.empty()) {
+						auto const parent = frames.back().v;
+						low[parent] = std::min(low[parent], low[v]);
+					}
+					if (low[v] == index[v]) {
+						auto first = std::find(stack.rbegin(), stack.rend(), v).base() - 1;
+						auto label = *std::min_element(first, stack.end());
+						for (auto w = first; w != stack.end(); ++w) {
+							on_stack[*w] = 0;
+							components[*w] = label;
+						}
+						stack.erase(first, stack.end());
+					}
+				}
+			}
+		}
+	} // namespace detail
+
+	// the strongly connected component of every node, by id, as the smallest id in its component.
+	// Following Hong et al., "On Fast Parallel Detection of Strongly Connected Components": nodes
+	// without edges in or out are trimmed as components of their own, then the component of the node
+	// of highest degree, usually the giant one, is the intersection of a parallel forward and
+	// backward search from it. What is left falls into pieces no component can span, those reached
+	// only forward, only backward or neither, and the weakly connected parts of each piece are handed
+	// to threads to finish with Tarjan's algorithm
+	template<typename N, typename E>
+	auto strongly_connected_components(csr_graph<N, E> const& g, std::size_t threads = detail::default_threads())
+	    -> std::vector<std::uint32_t> {
+		auto pool = detail::worker_pool(threads);
+		using node_id = std::uint32_t;
+		constexpr auto unassigned = std::numeric_limits<node_id>::max();
+		auto const n = g.num_nodes();
+		auto const in = detail::reverse_rows(g);
+		auto components = std::vector<node_id>(n, unassigned);
+
+		auto only_self = [](std::span<node_id const> row, node_id v) {
+			return std::all_of(row.begin(), row.end(), [v](node_id w) { return w == v; });
+		};
+		pool.run(n, 4096, [&](auto first, auto last, auto) {
+			for (auto i = first; i != last; ++i) {
+				auto v = static_cast<node_id>(i);
+				if (only_self(g.neighbours(v), v) or only_self(in.in(v), v)) {
+					components[v] = v;
+				}
+			}
+		});
+
+		auto pivot = std::optional<node_id>{};
+		auto best = std::size_t{0};
+		for (auto v = node_id{0}; v < n; ++v) {
+			auto degree = g.neighbours(v).size() * in.in(v).size();
+			if (components[v] == unassigned and (not pivot or degree > best)) {
+				pivot = v;
+				best = degree;
+			}
+		}
+		if (not pivot) {
+			return components;
+		}
+
+		auto alive = [&components](node_id v) { return components[v] == unassigned; };
+		auto out_of = [&g](node_id v) { return g.neighbours(v); };
+		auto into = [&in](node_id v) { return in.in(v); };
+		auto forward = detail::parallel_reach(pool, n, *pivot, out_of, alive);
+		auto backward = detail::parallel_reach(pool, n, *pivot, into, alive);
+		auto in_both = [&](node_id v) { return forward.test(v) and backward.test(v); };
+		auto label = static_cast<node_id>(std::min(forward.first(n), backward.first(n)));
+		for (; not in_both(label); ++label) {}
+		pool.run(n, 4096, [&](auto first, auto last, auto) {
+			for (auto i = first; i != last; ++i) {
+				auto v = static_cast<node_id>(i);
+				if (in_both(v)) {
+					components[v] = label;
+				}
+			}
+		});
+
+		// 0 reached forward only, 1 backward only, 2 neither, or unassigned once in a component
+		auto piece = std::vector<node_id>(n, unassigned);
+		for (auto v = node_id{0}; v < n; ++v) {
+			if (components[v] == unassigned) {
+				piece[v] = forward.test(v) ? 0 : backward.test(v) ? 1 : 2;
+			}
+		}
+		auto parts = detail::union_find(n);
+		pool.run(n, 256, [&](auto first, auto last, auto) {
+			for (auto i = first; i != last; ++i) {
+				auto v = static_cast<node_id>(i);
+				if (piece[v] != unassigned) {
+					for (auto w : g.neighbours(v)) {
+						if (piece[w] == piece[v]) {
+							parts.unite(v, w);
+						}
+					}
+				}
+			}
+		});
+
+		// the nodes of each part in a row, by counting sort on the root of their part
+		auto part = std::vector<node_id>(n);
+		auto starts = std::vector<std::size_t>(n + 1, 0);
+		for (auto v = node_id{0}; v < n; ++v) {
+			if (piece[v] != unassigned) {
+				part[v] = parts.find(v);
+				++starts[part[v] + 1];
+			}
+		}
+		std::partial_sum(starts.begin(), starts.end(), starts.begin());
+		auto members = std::vector<node_id>(starts.back());
+		auto fill = std::vector<std::size_t>(starts.begin(), starts.end() - 1);
+		auto roots = std::vector<node_id>{};
+		for (auto v = node_id{0}; v < n; ++v) {
+			if (piece[v] != unassigned) {
+				if (part[v] == v) {
+					roots.push_back(v);
+				}
+				members[fill[part[v]]++] = v;
+			}
+		}
+
+		auto index = std::vector<node_id>(n, 0);
+		auto low = std::vector<node_id>(n, 0);
+		auto on_stack = std::vector<char>(n, 0);
+		pool.run(roots.size(), 64, [&](auto first, auto last, auto) {
+			for (auto r = first; r != last; ++r) {
+				auto root = roots[r];
+				auto group = std::span<node_id const>{members}.subspan(starts[root], starts[root + 1] - starts[root]);
+				auto member = [&](node_id w) { return piece[w] != unassigned and part[w] == root; };
+				detail::tarjan(g, group, member, index, low, on_stack, components);
+			}
+		});
+		return components;
+	}
+
+	// the PageRank of every node, by id, after iters rounds of power iteration from the uniform
+	// distribution. A round is a sparse matrix vector product over the reversed edges, every node
+	// pulling the rank of its srcs so each entry is written by one thread, and the rank of nodes
+	// without out edges is spread evenly over every node, so the ranks keep summing to 1. Parallel
+	// edges each carry their share
+	template<typename N, typename E>
+	auto pagerank(csr_graph<N, E> const& g,
+	              std::size_t iters = 20,
+	              double damping = 0.85,
+	              std::size_t threads = detail::default_threads()) -> std::vector<double> {
+		if (not(damping >= 0.0 and damping <= 1.0)) {
+			auto emsg = std::string{"Cannot call gdwg::pagerank with a damping factor outside [0, 1]"};
+			throw std::runtime_error{emsg};
+		}
+		auto const n = g.num_nodes();
+		if (n == 0) {
+			return {};
+		}
+		auto pool = detail::worker_pool(threads);
+		auto const in = detail::reverse_rows(g);
+		auto const size = static_cast<double>(n);
+		auto rank = std::vector<double>(n, 1.0 / size);
+		auto next = std::vector<double>(n);
+		auto share = std::vector<double>(n);
+		// sums of the rank of nodes without out edges, one per chunk so the order of the additions
+		// doesn't depend on which thread took which chunk
+		constexpr auto chunk = std::size_t{4096};
+		auto dangling = std::vector<double>((n + chunk - 1) / chunk);
+		for (auto round = std::size_t{0}; round != iters; ++round) {
+			pool.run(n, chunk, [&](auto first, auto last, auto) {
+				auto lost = 0.0;
+				for (auto v = first; v != last; ++v) {
+					auto degree = g.neighbours(static_cast<std::uint32_t>(v)).size();
+					share[v] = degree == 0 ? 0.0 : rank[v] / static_cast<double>(degree);
+					lost += degree == 0 ? rank[v] : 0.0;
+				}
+				dangling[first / chunk] = lost;
+			});
+			auto const base = (1.0 - damping) / size
+			                  + damping * std::accumulate(dangling.begin(), dangling.end(), 0.0) / size;
+			pool.run(n, chunk, [&](auto first, auto last, auto) {
+				for (auto v = first; v != last; ++v) {
+					auto sum = 0.0;
+					for (auto src : in.in(static_cast<std::uint32_t>(v))) {
+						sum += share[src];
+					}
+					next[v] = base + damping * sum;
+				}
+			});
+			std::swap(rank, next);
+		}
+		return rank;
+	}
+} // namespace gdwg
+
+#endif // GDWG_PARALLEL_H
@@ -0,0 +1,321 @@
+#include "gdwg_parallel.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	// A -> B -> C, B -> D, E -> A, F on its own
+	auto make_graph() -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D", "E", "F"};
+		g.insert_edge("A", "B", 1);
+		g.insert_edge("B", "C");
+		g.insert_edge("B", "D", 2);
+		g.insert_edge("E", "A", 3);
+		return g;
+	}
+
+	// levels from a plain sequential bfs to check the parallel one against
+	auto expected_levels(gdwg::csr_graph<int, int> const& c, std::uint32_t src) -> std::vector<std::uint32_t> {
+		auto levels = std::vector<std::uint32_t>(c.num_nodes(), gdwg::reachability<int, int>::unreached);
+		auto queue = std::vector<std::uint32_t>{src};
+		levels[src] = 0;
+		for (auto head = std::size_t{0}; head != queue.size(); ++head) {
+			for (auto dst : c.neighbours(queue[head])) {
+				if (levels[dst] == gdwg::reachability<int, int>::unreached) {
+					levels[dst] = levels[queue[head]] + 1;
+					queue.push_back(dst);
+				}
+			}
+		}
+		return levels;
+	}
+
+	// a graph with a few cycles of different sizes, which links some of them one way, a long chain
+	// and a handful of nodes on their own
+	auto make_components_graph() -> gdwg::csr_graph<int, int> {
+		constexpr auto n = 3000;
+		auto rng = std::mt19937{6771};
+		auto pick = std::uniform_int_distribution<int>{0, n - 1};
+		auto g = gdwg::graph<int, int>{};
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+		for (auto i = 0; i < 6000; ++i) {
+			g.insert_edge(pick(rng) % 800, pick(rng) % 800);
+		}
+		for (auto start = 800; start < 2000; start += 40) {
+			for (auto i = start; i < start + 39; ++i) {
+				g.insert_edge(i, i + 1);
+			}
+			g.insert_edge(start + 39, start + (start % 7));
+			g.insert_edge(pick(rng), start);
+		}
+		for (auto i = 2000; i < 2900; ++i) {
+			g.insert_edge(i + 1, i);
+		}
+		g.insert_edge(2950, 2950);
+		return gdwg::csr_graph<int, int>{g};
+	}
+
+	// components by id labelled with their smallest id, the sequential way: mutual reachability for
+	// the strong ones, and a search over edges in both directions for the weak ones
+	auto expected_components(gdwg::csr_graph<int, int> const& c, bool strong) -> std::vector<std::uint32_t> {
+		auto const n = static_cast<std::uint32_t>(c.num_nodes());
+		auto in = std::vector<std::vector<std::uint32_t>>(n);
+		for (auto v = std::uint32_t{0}; v < n; ++v) {
+			for (auto w : c.neighbours(v)) {
+				in[w].push_back(v);
+			}
+		}
+		auto search = [&](std::uint32_t src, bool forward, bool backward) {
+			auto seen = std::vector<char>(n, 0);
+			auto queue = std::vector<std::uint32_t>{src};
+			seen[src] = 1;
+			for (auto head = std::size_t{0}; head != queue.size(); ++head) {
+				auto v = queue[head];
+				auto visit = [&](std::uint32_t w) {
+					if (seen[w] == 0) {
+						seen[w] = 1;
+						queue.push_back(w);
+					}
+				};
+				if (forward) {
+					for (auto w : c.neighbours(v)) {
+						visit(w);
+					}
+				}
+				if (backward) {
+					for (auto w : in[v]) {
+						visit(w);
+					}
+				}
+			}
+			return seen;
+		};
+		auto res = std::vector<std::uint32_t>(n, n);
+		for (auto v = std::uint32_t{0}; v < n; ++v) {
+			if (res[v] != n) {
+				continue;
+			}
+			auto ahead = search(v, true, not strong);
+			auto behind = strong ? search(v, false, true) : ahead;
+			for (auto w = v; w < n; ++w) {
+				if (ahead[w] != 0 and behind[w] != 0) {
+					res[w] = v;
+				}
+			}
+		}
+		return res;
+	}
+} // namespace
+
+TEST_CASE("is_reachable") {
+	auto c = gdwg::csr_graph<std::string, int>{make_graph()};
+	auto r = gdwg::reachability<std::string, int>{c, 2};
+	CHECK(r.is_reachable("E", "D"));
+	CHECK(r.is_reachable("A", "A"));
+	CHECK_FALSE(r.is_reachable("D", "A"));
+	CHECK_FALSE(r.is_reachable("A", "F"));
+	CHECK_THROWS_WITH(r.is_reachable("A", "X"),
+	                  "Cannot call gdwg::reachability<N, E>::is_reachable if src or dst node don't exist in the graph");
+
+	SECTION("batched queries keep their order") {
+		auto id = [&](std::string const& n) { return *c.id(n); };
+		auto queries = std::vector<gdwg::reachability<std::string, int>::query>{
+		   {id("B"), id("C")},
+		   {id("A"), id("E")},
+		   {id("E"), id("C")},
+		   {id("B"), id("A")},
+		   {id("F"), id("F")},
+		};
+		CHECK(r.is_reachable(queries) == std::vector<bool>{true, false, true, false, true});
+		CHECK(r.is_reachable(std::span<gdwg::reachability<std::string, int>::query const>{}).empty());
+	}
+	SECTION("hops from a source") {
+		CHECK(r.bfs(*c.id("E")) == std::vector<std::uint32_t>{1, 2, 3, 3, 0, r.unreached});
+	}
+}
+
+TEST_CASE("Parallel searches agree with a sequential one") {
+	constexpr auto n = 3000;
+	auto rng = std::mt19937{6771};
+	auto pick = std::uniform_int_distribution<int>{0, n - 1};
+	auto g = gdwg::graph<int, int>{};
+	for (auto i = 0; i < n; ++i) {
+		g.insert_node(i);
+	}
+	// a dense core reached through a long chain, so the search has to switch direction both ways
+	for (auto i = 0; i < 20000; ++i) {
+		g.insert_edge(pick(rng) % 500, pick(rng) % 500);
+	}
+	for (auto i = 500; i < n; ++i) {
+		g.insert_edge(i - 1, i);
+		g.insert_edge(i, pick(rng));
+	}
+	auto c = gdwg::csr_graph<int, int>{g};
+
+	for (auto threads : {1, 4}) {
+		auto r = gdwg::reachability<int, int>{c, static_cast<std::size_t>(threads)};
+		for (auto src : {0U, 250U, 1700U, 2999U}) {
+			CHECK(r.bfs(src) == expected_levels(c, src));
+		}
+
+		auto queries = std::vector<gdwg::reachability<int, int>::query>{};
+		for (auto i = 0; i < 1000; ++i) {
+			queries.emplace_back(static_cast<std::uint32_t>(pick(rng)), static_cast<std::uint32_t>(pick(rng)));
+		}
+		auto answers = r.is_reachable(queries);
+		REQUIRE(answers.size() == queries.size());
+		auto mismatches = 0;
+		for (auto i = std::size_t{0}; i != queries.size(); ++i) {
+			auto levels = expected_levels(c, queries[i].first);
+			if (answers[i] != (levels[queries[i].second] != r.unreached)) {
+				++mismatches;
+			}
+		}
+		CHECK(mismatches == 0);
+	}
+}
+
+TEST_CASE("Connected components") {
+	auto g = make_graph();
+	SECTION("weakly connected") {
+		auto c = gdwg::csr_graph<std::string, int>{g};
+		CHECK(gdwg::weakly_connected_components(c, 2) == std::vector<std::uint32_t>{0, 0, 0, 0, 0, 5});
+	}
+	SECTION("strongly connected") {
+		CHECK(gdwg::strongly_connected_components(gdwg::csr_graph<std::string, int>{g})
+		      == std::vector<std::uint32_t>{0, 1, 2, 3, 4, 5});
+		g.insert_edge("C", "A", 1);
+		g.insert_edge("F", "F", 1);
+		auto c = gdwg::csr_graph<std::string, int>{g};
+		CHECK(gdwg::strongly_connected_components(c, 2) == std::vector<std::uint32_t>{0, 0, 0, 3, 4, 5});
+	}
+	SECTION("empty graph") {
+		auto c = gdwg::csr_graph<int, int>{};
+		CHECK(gdwg::weakly_connected_components(c).empty());
+		CHECK(gdwg::strongly_connected_components(c).empty());
+	}
+}
+
+TEST_CASE("Parallel components agree with sequential ones") {
+	auto c = make_components_graph();
+	auto weak = expected_components(c, false);
+	auto strong = expected_components(c, true);
+	for (auto threads : {1, 4}) {
+		CHECK(gdwg::weakly_connected_components(c, static_cast<std::size_t>(threads)) == weak);
+		CHECK(gdwg::strongly_connected_components(c, static_cast<std::size_t>(threads)) == strong);
+	}
+}
+
+TEST_CASE("Searches keep working as they and later calls ask for more threads") {
+	// a binary tree, so every level of a search from the root has room for twice the threads
+	constexpr auto n = 1 << 15;
+	auto g = gdwg::graph<int, int>{};
+	for (auto i = 0; i < n; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 1; i < n; ++i) {
+		g.insert_edge((i - 1) / 2, i);
+	}
+	auto c = gdwg::csr_graph<int, int>{g};
+	auto levels = expected_levels(c, 0);
+	auto weak = std::vector<std::uint32_t>(n, 0);
+	auto strong = std::vector<std::uint32_t>(n);
+	std::iota(strong.begin(), strong.end(), 0U);
+	auto rank = gdwg::pagerank(c, 5, 0.85, 1);
+	for (auto threads : {std::size_t{1}, std::size_t{2}, std::size_t{8}}) {
+		CHECK(gdwg::reachability<int, int>{c, threads}.bfs(0) == levels);
+		CHECK(gdwg::weakly_connected_components(c, threads) == weak);
+		CHECK(gdwg::strongly_connected_components(c, threads) == strong);
+		CHECK(gdwg::pagerank(c, 5, 0.85, threads) == rank);
+	}
+}
+
+TEST_CASE("pagerank") {
+	SECTION("ranks sum to one and favour the nodes linked to") {
+		auto c = gdwg::csr_graph<std::string, int>{make_graph()};
+		auto rank = gdwg::pagerank(c, 50, 0.85, 2);
+		REQUIRE(rank.size() == 6);
+		CHECK(std::accumulate(rank.begin(), rank.end(), 0.0) == Approx(1.0));
+		// E has no edges in, A only the one from E
+		CHECK(rank[*c.id("A")] > rank[*c.id("E")]);
+		CHECK(rank[*c.id("C")] == Approx(rank[*c.id("D")]));
+		CHECK(rank[*c.id("E")] == Approx(rank[*c.id("F")]));
+	}
+	SECTION("a cycle ranks every node the same") {
+		auto g = gdwg::graph<int, int>{0, 1, 2, 3};
+		for (auto i = 0; i < 4; ++i) {
+			g.insert_edge(i, (i + 1) % 4, 1);
+		}
+		auto rank = gdwg::pagerank(gdwg::csr_graph<int, int>{g}, 10);
+		for (auto r : rank) {
+			CHECK(r == Approx(0.25));
+		}
+	}
+	SECTION("a star ranks its centre first") {
+		auto g = gdwg::graph<int, int>{0, 1, 2, 3};
+		for (auto i = 1; i < 4; ++i) {
+			g.insert_edge(i, 0, 1);
+		}
+		auto rank = gdwg::pagerank(gdwg::csr_graph<int, int>{g}, 100);
+		// once converged, every leaf gets what the centre spreads, (1 - d) / 4 + d * rank[0] / 4
+		CHECK(rank[1] == Approx(0.15 / 4 + 0.85 * rank[0] / 4));
+		CHECK(rank[0] == Approx(1.0 - 3 * rank[1]));
+	}
+	SECTION("the same ranks on any number of threads") {
+		auto c = make_components_graph();
+		CHECK(gdwg::pagerank(c, 20, 0.85, 1) == gdwg::pagerank(c, 20, 0.85, 4));
+		CHECK(gdwg::pagerank(c, 0) == std::vector<double>(c.num_nodes(), 1.0 / 3000));
+	}
+	CHECK(gdwg::pagerank(gdwg::csr_graph<int, int>{}).empty());
+	CHECK_THROWS_WITH(gdwg::pagerank(gdwg::csr_graph<int, int>{}, 20, 1.5),
+	                  "Cannot call gdwg::pagerank with a damping factor outside [0, 1]");
+}
+
+TEST_CASE("Worker pool") {
+	auto pool = gdwg::detail::worker_pool{4};
+	SECTION("every chunk runs once, loop after loop on the same threads") {
+		for (auto count : {std::size_t{0}, std::size_t{1}, std::size_t{100}, std::size_t{5000}}) {
+			auto hits = std::vector<std::atomic<int>>(count);
+			// Catch isn't thread safe, so the workers only record what is checked afterwards
+			auto stray = std::atomic<bool>{false};
+			pool.run(count, 7, [&](auto first, auto last, auto worker) {
+				stray = stray or worker >= pool.threads();
+				for (auto i = first; i != last; ++i) {
+					hits[i].fetch_add(1);
+				}
+			});
+			CHECK(not stray);
+			CHECK(std::all_of(hits.begin(), hits.end(), [](auto const& h) { return h.load() == 1; }));
+		}
+	}
+	SECTION("loops that need more workers than the last one start helpers partway through") {
+		for (auto round = 0; round < 200; ++round) {
+			auto wide = gdwg::detail::worker_pool{8};
+			for (auto count : {std::size_t{2}, std::size_t{1}, std::size_t{4}, std::size_t{8}, std::size_t{3}}) {
+				auto total = std::atomic<std::size_t>{0};
+				wide.run(count, 1, [&total](auto first, auto last, auto) { total.fetch_add(last - first); });
+				CHECK(total == count);
+			}
+		}
+	}
+	SECTION("the first exception thrown by a chunk reaches the caller") {
+		auto throwing = [](auto first, auto, auto) {
+			if (first >= 64) {
+				throw std::runtime_error{"chunk failed"};
+			}
+		};
+		CHECK_THROWS_WITH(pool.run(1000, 8, throwing), "chunk failed");
+		auto total = std::atomic<std::size_t>{0};
+		pool.run(1000, 8, [&total](auto first, auto last, auto) { total.fetch_add(last - first); });
+		CHECK(total == 1000);
+	}
+}
@@ -0,0 +1,243 @@
+#ifndef GDWG_SIMD_H
+#	define GDWG_SIMD_H
+
+#	include <algorithm>
+#	include <bit>
+#	include <cstddef>
+#	include <cstdint>
+#	include <span>
+#	include <vector>
+
+#	if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#		define GDWG_SIMD_AVX2 1
+#		include <immintrin.h>
+#	endif
+
+namespace gdwg {
+	// Kernels over sorted runs of node ids, e.g. the rows of a csr_graph. Every kernel has a scalar
+	// version and, on x86-64, an AVX2 version picked at run time when the processor supports it,
+	// so the library is still built for the baseline instruction set.
+	namespace detail::simd {
+		using id = std::uint32_t;
+
+		// lists this much longer than the other are searched rather than merged
+		inline constexpr auto skew = std::size_t{32};
+
+		namespace scalar {
+			inline auto lower_bound(std::span<id const> run, id value) noexcept -> std::size_t {
+				return static_cast<std::size_t>(std::lower_bound(run.begin(), run.end(), value) - run.begin());
+			}
+
+			// appends the values found in both a and b to out, once each
+			inline void intersect(std::span<id const> a, std::span<id const> b, std::vector<id>& out) {
+				auto i = std::size_t{0};
+				auto j = std::size_t{0};
+				while (i < a.size() and j < b.size()) {
+					if (a[i] < b[j]) {
+						++i;
+					}
+					else if (b[j] < a[i]) {
+						++j;
+					}
+					else {
+						if (out.empty() or out.back() != a[i]) {
+							out.push_back(a[i]);
+						}
+						++i;
+						++j;
+					}
+				}
+			}
+
+			// the number of values found in both a and b, each strictly increasing
+			inline auto intersect_count(std::span<id const> a, std::span<id const> b) noexcept -> std::size_t {
+				auto count = std::size_t{0};
+				auto i = std::size_t{0};
+				auto j = std::size_t{0};
+				while (i < a.size() and j < b.size()) {
+					if (a[i] < b[j]) {
+						++i;
+					}
+					else if (b[j] < a[i]) {
+						++j;
+					}
+					else {
+						++count;
+						++i;
+						++j;
+					}
+				}
+				return count;
+			}
+		} // namespace scalar
+
+#	ifdef GDWG_SIMD_AVX2
+		namespace avx2 {
+			[[gnu::target("avx2")]] inline auto load(id const* p) noexcept -> __m256i {
+				return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+			}
+
+			// bit k is set if the kth value of the block at a is anywhere in the block at b. The block
+			// from b is rotated one lane at a time, so every pair of lanes is compared once
+			[[gnu::target("avx2")]] inline auto block_matches(id const* a, id const* b) noexcept -> unsigned {
+				auto const rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+				auto va = load(a);
+				auto vb = load(b);
+				auto eq = _mm256_cmpeq_epi32(va, vb);
+				for (auto r = 1; r != 8; ++r) {
+					vb = _mm256_permutevar8x32_epi32(vb, rotate);
+					eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+				}
+				return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+			}
+
+			// the number of the 8 values at p that are less than value. The comparison is signed, so the
+			// sign bit is flipped first
+			[[gnu::target("avx2")]] inline auto count_below(id const* p, id value) noexcept -> std::size_t {
+				auto const flip = _mm256_set1_epi32(static_cast<int>(0x80000000U));
+				auto const key = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(value)), flip);
+				auto lt = _mm256_cmpgt_epi32(key, _mm256_xor_si256(load(p), flip));
+				auto mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(lt)));
+				return static_cast<std::size_t>(std::popcount(mask));
+			}
+
+			// binary search down to a window of 16, then the values below value in it are counted
+			// two blocks at a time
+			[[gnu::target("avx2")]] inline auto lower_bound(std::span<id const> run, id value) noexcept -> std::size_t {
+				auto first = std::size_t{0};
+				auto len = run.size();
+				while (len > 16) {
+					auto half = len / 2;
+					if (run[first + half] < value) {
+						first += half + 1;
+						len -= half + 1;
+					}
+					else {
+						len = half;
+					}
+				}
+				if (len < 16) {
+					return first + scalar::lower_bound(run.subspan(first, len), value);
+				}
+				auto p = run.data() + first;
+				return first + count_below(p, value) + count_below(p + 8, value);
+			}
+
+			// blocks of 8 from each list are compared all against all, and whichever block ends with the
+			// smaller value moves on. Values come out of a in order, so a repeat is always out.back()
+			[[gnu::target("avx2")]] inline void intersect(std::span<id const> a,
+			                                              std::span<id const> b,
+			                                              std::vector<id>& out) {
+				auto i = std::size_t{0};
+				auto j = std::size_t{0};
+				while (i + 8 <= a.size() and j + 8 <= b.size()) {
+					for (auto found = block_matches(&a[i], &b[j]); found != 0; found &= found - 1) {
+						auto value = a[i + static_cast<std::size_t>(std::countr_zero(found))];
+						if (out.empty() or out.back() != value) {
+							out.push_back(value);
+						}
+					}
+					auto a_last = a[i + 7];
+					auto b_last = b[j + 7];
+					i += a_last <= b_last ? 8 : 0;
+					j += b_last <= a_last ? 8 : 0;
+				}
+				scalar::intersect(a.subspan(i), b.subspan(j), out);
+			}
+
+			[[gnu::target("avx2")]] inline auto intersect_count(std::span<id const> a, std::span<id const> b) noexcept
+			    -> std::size_t {
+				auto count = std::size_t{0};
+				auto i = std::size_t{0};
+				auto j = std::size_t{0};
+				while (i + 8 <= a.size() and j + 8 <= b.size()) {
+					count += static_cast<std::size_t>(std::popcount(block_matches(&a[i], &b[j])));
+					auto a_last = a[i + 7];
+					auto b_last = b[j + 7];
+					i += a_last <= b_last ? 8 : 0;
+					j += b_last <= a_last ? 8 : 0;
+				}
+				return count + scalar::intersect_count(a.subspan(i), b.subspan(j));
+			}
+		} // namespace avx2
+#	endif
+
+		inline auto has_avx2() noexcept -> bool {
+#	ifdef GDWG_SIMD_AVX2
+			static auto const supported = [] {
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("avx2") != 0;
+			}();
+			return supported;
+#	else
+			return false;
+#	endif
+		}
+
+		// the position of the first value in run that is not less than value
+		inline auto lower_bound(std::span<id const> run, id value) noexcept -> std::size_t {
+#	ifdef GDWG_SIMD_AVX2
+			if (has_avx2()) {
+				return avx2::lower_bound(run, value);
+			}
+#	endif
+			return scalar::lower_bound(run, value);
+		}
+
+		// for each value of the short list, searches what is left of the long list
+		template<typename Found>
+		void search_each(std::span<id const> shorter, std::span<id const> longer, Found found) {
+			for (auto value : shorter) {
+				longer = longer.subspan(lower_bound(longer, value));
+				if (longer.empty()) {
+					return;
+				}
+				if (longer.front() == value) {
+					found(value);
+				}
+			}
+		}
+
+		// appends the values found in both sorted runs a and b to out, once each
+		inline void intersect(std::span<id const> a, std::span<id const> b, std::vector<id>& out) {
+			if (a.size() > b.size()) {
+				std::swap(a, b);
+			}
+			if (a.size() * skew < b.size()) {
+				search_each(a, b, [&out](id value) {
+					if (out.empty() or out.back() != value) {
+						out.push_back(value);
+					}
+				});
+				return;
+			}
+#	ifdef GDWG_SIMD_AVX2
+			if (has_avx2()) {
+				avx2::intersect(a, b, out);
+				return;
+			}
+#	endif
+			scalar::intersect(a, b, out);
+		}
+
+		// the number of values found in both a and b, which must be strictly increasing
+		inline auto intersect_count(std::span<id const> a, std::span<id const> b) noexcept -> std::size_t {
+			if (a.size() > b.size()) {
+				std::swap(a, b);
+			}
+			if (a.size() * skew < b.size()) {
+				auto count = std::size_t{0};
+				search_each(a, b, [&count](id) { ++count; });
+				return count;
+			}
+#	ifdef GDWG_SIMD_AVX2
+			if (has_avx2()) {
+				return avx2::intersect_count(a, b);
+			}
+#	endif
+			return scalar::intersect_count(a, b);
+		}
+	} // namespace detail::simd
+} // namespace gdwg
+
+#endif // GDWG_SIMD_H
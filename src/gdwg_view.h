@@ -0,0 +1,149 @@
+#ifndef GDWG_VIEW_H
+#	define GDWG_VIEW_H
+
+#	include "gdwg_graph.h"
+
+#	include <algorithm>
+#	include <functional>
+#	include <memory>
+#	include <ranges>
+#	include <stdexcept>
+#	include <string>
+#	include <utility>
+#	include <vector>
+
+namespace gdwg {
+	// A lazy subgraph of g: the nodes for which node_pred holds, and the edges between two of them
+	// for which edge_pred holds as well. Nothing is copied, every member walks the storage of g and
+	// tests the predicates on the way, so like the views of the graph itself it is only valid until
+	// g is modified. node_pred is only given nodes stored in g, and edge_pred the (from, to, weight)
+	// references that iterating g yields.
+	template<typename N,
+	         typename E,
+	         typename NodeIndex,
+	         typename InIndex,
+	         typename Instrument,
+	         typename NodePred,
+	         typename EdgePred>
+	class filtered_view {
+	 public:
+		using graph_type = graph<N, E, NodeIndex, InIndex, Instrument>;
+
+		// g must outlive the view
+		filtered_view(graph<N, E, NodeIndex, InIndex, Instrument> const& g, NodePred node_pred, EdgePred edge_pred)
+		: g_{&g}
+		, node_pred_{std::move(node_pred)}
+		, edge_pred_{std::move(edge_pred)} {}
+
+		// accessors
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			auto node = g_->find_node(value);
+			return node != nullptr and std::invoke(node_pred_, *node);
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			if (is_node(src) and is_node(dst)) {
+				auto out = out_edges(src);
+				auto to = [](auto const& e) -> N const& { return e.to; };
+				auto between = std::ranges::equal_range(out.base(), dst, std::less<>{}, to);
+				return std::ranges::any_of(between, keep());
+			}
+			auto emsg = std::string{"Cannot call gdwg::filtered_view<N, E>::is_connected if src or dst node don't exist "
+			                        "in the view"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the number of edges of the view out of src
+		[[nodiscard]] auto out_degree(N const& src) const -> std::size_t {
+			if (is_node(src)) {
+				auto out = out_edges(src);
+				return static_cast<std::size_t>(std::ranges::distance(out));
+			}
+			auto emsg = std::string{"Cannot call gdwg::filtered_view<N, E>::out_degree if src doesn't exist in the view"};
+			throw std::runtime_error{emsg};
+		}
+
+		// Views, in the order the graph keeps them
+		[[nodiscard]] auto nodes() const {
+			return g_->nodes_view() | std::views::filter(node_pred_);
+		}
+
+		[[nodiscard]] auto edges() const {
+			return std::ranges::subrange(g_->begin(), g_->end()) | std::views::filter(keep());
+		}
+
+		// the edges of the view out of src, found by binary search in the edges of the graph
+		[[nodiscard]] auto out_edges(N const& src) const {
+			if (is_node(src)) {
+				auto from = [](auto const& e) -> N const& { return e.from; };
+				auto block = std::ranges::equal_range(g_->begin(), g_->end(), src, std::less<>{}, from);
+				return block | std::views::filter(keep());
+			}
+			auto emsg = std::string{"Cannot call gdwg::filtered_view<N, E>::out_edges if src doesn't exist in the view"};
+			throw std::runtime_error{emsg};
+		}
+
+		// the graph being viewed
+		[[nodiscard]] auto base() const noexcept -> graph_type const& {
+			return *g_;
+		}
+
+	 private:
+		graph_type const* g_;
+		NodePred node_pred_;
+		EdgePred edge_pred_;
+
+		// the test an edge of the view passes. It holds copies of the predicates, so the ranges it
+		// filters don't refer back to the view
+		auto keep() const {
+			return [node_pred = node_pred_, edge_pred = edge_pred_](auto const& e) {
+				return std::invoke(node_pred, e.from) and std::invoke(node_pred, e.to) and std::invoke(edge_pred, e);
+			};
+		}
+	};
+
+	namespace detail {
+		// the nodes of an induced subgraph, by address. Shared so the copies a view takes are cheap
+		template<typename N>
+		struct node_set {
+			std::shared_ptr<std::vector<N const*> const> members;
+
+			auto operator()(N const& node) const noexcept -> bool {
+				return std::ranges::binary_search(*members, &node);
+			}
+		};
+
+		struct any_edge {
+			auto operator()(auto const&) const noexcept -> bool {
+				return true;
+			}
+		};
+	} // namespace detail
+
+	// the subgraph of g on the nodes in the range nodes, holding every edge of g between two of them
+	template<typename N,
+	         typename E,
+	         typename NodeIndex,
+	         typename InIndex,
+	         typename Instrument,
+	         std::ranges::input_range R>
+	auto induced_subgraph_view(graph<N, E, NodeIndex, InIndex, Instrument> const& g, R&& nodes)
+	    -> filtered_view<N, E, NodeIndex, InIndex, Instrument, detail::node_set<N>, detail::any_edge> {
+		auto members = std::vector<N const*>{};
+		for (auto const& value : nodes) {
+			auto node = g.find_node(value);
+			if (node == nullptr) {
+				auto emsg = std::string{"Cannot call gdwg::induced_subgraph_view on a node that doesn't exist in the "
+				                        "graph"};
+				throw std::runtime_error{emsg};
+			}
+			members.push_back(node);
+		}
+		std::ranges::sort(members);
+		members.erase(std::unique(members.begin(), members.end()), members.end());
+		auto set = detail::node_set<N>{std::make_shared<std::vector<N const*> const>(std::move(members))};
+		return {g, std::move(set), detail::any_edge{}};
+	}
+} // namespace gdwg
+
+#endif // GDWG_VIEW_H
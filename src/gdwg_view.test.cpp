@@ -0,0 +1,87 @@
+#include "gdwg_view.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+	auto make_graph() -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D"};
+		g.insert_edge("A", "B", 1);
+		g.insert_edge("A", "B", 5);
+		g.insert_edge("A", "C", 2);
+		g.insert_edge("B", "C");
+		g.insert_edge("C", "A", 3);
+		g.insert_edge("D", "A", 4);
+		return g;
+	}
+
+	template<typename Range>
+	auto printed(Range&& edges) -> std::vector<std::string> {
+		auto res = std::vector<std::string>{};
+		for (auto const& [from, to, weight] : edges) {
+			res.push_back(from + " -> " + to + (weight ? " | " + std::to_string(*weight) : ""));
+		}
+		return res;
+	}
+} // namespace
+
+TEST_CASE("Degrees") {
+	auto g = make_graph();
+	CHECK(g.out_degree("A") == 3);
+	CHECK(g.out_degree("D") == 1);
+	CHECK(g.in_degree("A") == 2);
+	CHECK(g.in_degree("D") == 0);
+	CHECK_THROWS_WITH(g.out_degree("T"), "Cannot call gdwg::graph<N, E>::out_degree if src doesn't exist in the graph");
+	CHECK_THROWS_WITH(g.in_degree("T"), "Cannot call gdwg::graph<N, E>::in_degree if dst doesn't exist in the graph");
+
+	auto b = gdwg::bidirectional_graph<std::string, int>{"A", "B", "C", "D"};
+	for (auto const& [from, to, weight] : g) {
+		b.insert_edge(from, to, weight);
+	}
+	for (auto const& n : g.nodes()) {
+		CHECK(b.in_degree(n) == g.in_degree(n));
+		CHECK(b.out_degree(n) == g.out_degree(n));
+	}
+}
+
+TEST_CASE("filtered_view") {
+	auto g = make_graph();
+	auto heavy = [](auto const& e) { return not e.weight or *e.weight > 1; };
+	auto v = gdwg::filtered_view(g, [](std::string const& n) { return n != "D"; }, heavy);
+
+	CHECK(std::ranges::equal(v.nodes(), std::vector<std::string>{"A", "B", "C"}));
+	CHECK(printed(v.edges()) == std::vector<std::string>{"A -> B | 5", "A -> C | 2", "B -> C", "C -> A | 3"});
+	CHECK(printed(v.out_edges("A")) == std::vector<std::string>{"A -> B | 5", "A -> C | 2"});
+	CHECK(v.out_degree("A") == 2);
+	CHECK(v.is_node("A"));
+	CHECK_FALSE(v.is_node("D"));
+	CHECK(v.is_connected("C", "A"));
+	CHECK_FALSE(v.is_connected("B", "A"));
+	CHECK_THROWS_WITH(v.is_connected("D", "A"),
+	                  "Cannot call gdwg::filtered_view<N, E>::is_connected if src or dst node don't exist in the view");
+	CHECK_THROWS_WITH(v.out_edges("D"),
+	                  "Cannot call gdwg::filtered_view<N, E>::out_edges if src doesn't exist in the view");
+	CHECK_THROWS_WITH(v.out_degree("D"),
+	                  "Cannot call gdwg::filtered_view<N, E>::out_degree if src doesn't exist in the view");
+	CHECK(&v.base() == &g);
+
+	SECTION("the view follows the graph rather than copying it") {
+		g.insert_edge("B", "A", 7);
+		CHECK(v.is_connected("B", "A"));
+	}
+}
+
+TEST_CASE("induced_subgraph_view") {
+	auto g = make_graph();
+	auto v = gdwg::induced_subgraph_view(g, std::vector<std::string>{"C", "A", "C"});
+	CHECK(std::ranges::equal(v.nodes(), std::vector<std::string>{"A", "C"}));
+	CHECK(printed(v.edges()) == std::vector<std::string>{"A -> C | 2", "C -> A | 3"});
+	CHECK(v.out_degree("A") == 1);
+	CHECK_FALSE(v.is_node("B"));
+	auto copy = v;
+	CHECK(printed(copy.out_edges("C")) == std::vector<std::string>{"C -> A | 3"});
+	CHECK_THROWS_WITH(gdwg::induced_subgraph_view(g, std::vector<std::string>{"A", "T"}),
+	                  "Cannot call gdwg::induced_subgraph_view on a node that doesn't exist in the graph");
+}